@@ -1,23 +1,36 @@
 #include "BeastClient.hpp"
 
+#include <algorithm>
 #include <boost/beast/core/detail/base64.hpp>
 #include <boost/beast/http.hpp>
+#include <utility>
 
 #include "Implementation/Beast/Connector/DirectConnector.hpp"
 #include "Implementation/Beast/Connector/ProxyConnector.hpp"
 
 namespace WS {
 BeastClient::BeastClient(IWebSocketClientCallback& callback, IWriterOperator& writer_callback,
-                         const ServerSettings& settings, net::io_context& ioc, ssl::context& ctx)
-    : callback_(callback),
+                         const ConnectionConfig& config, const StrandExecutor& executor,
+                         std::shared_ptr<TlsContext> tls_context,
+                         std::shared_ptr<void> lifetime_guard)
+    : tls_context_(std::move(tls_context)),
+      session_key_(config.server_settings.host + ":" +
+                   std::to_string(config.server_settings.port)),
+      ws_(executor, tls_context_->GetContext()),
+      callback_(callback),
       writer_callback_(writer_callback),
-      server_settings_(settings),
-      ioc_(ioc),
-      ws_(net::make_strand(ioc), ctx) {
+      connection_config_(config),
+      server_settings_(connection_config_.server_settings),
+      lifetime_guard_(std::move(lifetime_guard)) {
+    read_buffer_.reserve(connection_config_.streaming_receive_chunk_size
+                             ? *connection_config_.streaming_receive_chunk_size
+                             : connection_config_.read_buffer_initial_capacity);
+    beast::get_lowest_layer(ws_).rate_policy().SetObserver(&callback_);
+
     if (server_settings_.proxy_settings) {
-        connector_ = std::make_shared<ProxyConnector>(ioc, ws_);
+        connector_ = std::make_shared<ProxyConnector>(executor, ws_, callback_);
     } else {
-        connector_ = std::make_shared<DirectConnector>(ioc, ws_);
+        connector_ = std::make_shared<DirectConnector>(executor, ws_, callback_);
     }
 }
 
@@ -38,13 +51,74 @@ bool BeastClient::Open() {
     return true;
 }
 
-bool BeastClient::Send(std::string_view message) {
+bool BeastClient::Send(std::string_view message, MessageType type) {
     if (connection_state_ != ConnectionState::Connected) {
         return false;
     }
 
+    // Only one write is in flight at a time, so the opcode can be switched per message
+    ws_.binary(type == MessageType::Binary);
     ws_.async_write(net::buffer(message),
-                    beast::bind_front_handler(&BeastClient::OnWrite, shared_from_this()));
+                    BindWriteMemory(beast::bind_front_handler(&BeastClient::OnWrite,
+                                                              shared_from_this())));
+
+    return true;
+}
+
+bool BeastClient::SendBatch(std::span<const std::string_view> messages, MessageType type,
+                            std::optional<std::string_view> delimiter) {
+    if (connection_state_ != ConnectionState::Connected || messages.empty()) {
+        return false;
+    }
+
+    ws_.binary(type == MessageType::Binary);
+    batch_buffers_.clear();
+
+    if (delimiter) {
+        // Gather all messages into a single WebSocket message without copying the payloads
+        for (size_t i = 0; i < messages.size(); ++i) {
+            if (i > 0) {
+                batch_buffers_.push_back(net::buffer(*delimiter));
+            }
+            batch_buffers_.push_back(net::buffer(messages[i]));
+        }
+
+        ws_.async_write(batch_buffers_,
+                        BindWriteMemory(beast::bind_front_handler(&BeastClient::OnWrite,
+                                                                  shared_from_this())));
+        return true;
+    }
+
+    // Each message keeps its own frame. Frames are written back-to-back and the writer is
+    // notified once for the whole batch; all but the last are held back below the WebSocket
+    // layer, so the whole batch reaches TLS in one write.
+    for (std::string_view message : messages) {
+        batch_buffers_.push_back(net::buffer(message));
+    }
+    next_batch_frame_ = 0;
+    batch_frame_ends_.clear();
+    WriteNextBatchFrame();
+
+    return true;
+}
+
+bool BeastClient::SendStream(std::shared_ptr<IMessageStreamProducer> producer, MessageType type) {
+    if (connection_state_ != ConnectionState::Connected || !producer) {
+        return false;
+    }
+
+    ws_.binary(type == MessageType::Binary);
+    stream_producer_ = std::move(producer);
+    stream_chunk_.resize(std::max<size_t>(connection_config_.streaming_send_chunk_size, 1));
+    stream_bytes_written_ = 0;
+    stream_last_chunk_ = false;
+    stream_producer_->OnWriteStarted(
+        [client = weak_from_this(), generation = ++stream_generation_]() {
+            if (auto self = client.lock()) {
+                self->PostStreamResume(generation);
+            }
+        });
+    WriteNextStreamFragment();
 
     return true;
 }
@@ -57,15 +131,39 @@ void BeastClient::Close() {
     CompleteClose();
 }
 
+void BeastClient::PauseReading() { read_paused_ = true; }
+
+void BeastClient::ResumeReading() {
+    read_paused_ = false;
+    if (!read_in_progress_ && connection_state_ == ConnectionState::Connected && !should_stop_) {
+        PerformRead();
+    }
+}
+
 bool BeastClient::IsConnected() const { return connection_state_ == ConnectionState::Connected; }
 
 bool BeastClient::SetupWS() {
-    if (!SSL_set_tlsext_host_name(ws_.next_layer().native_handle(),
+    if (!SSL_set_tlsext_host_name(GetTlsStream().native_handle(),
                                   server_settings_.host.c_str())) {
         return false;
     }
 
-    ws_.next_layer().set_verify_callback(ssl::host_name_verification(server_settings_.host));
+    GetTlsStream().set_verify_callback(ssl::host_name_verification(server_settings_.host));
+    ws_.read_message_max(connection_config_.read_message_max);
+
+    const CompressionSettings& compression = connection_config_.compression;
+    if (compression.enabled) {
+        websocket::permessage_deflate deflate;
+        deflate.client_enable = true;
+        deflate.client_max_window_bits = compression.client_max_window_bits;
+        deflate.server_max_window_bits = compression.server_max_window_bits;
+        deflate.client_no_context_takeover = compression.client_no_context_takeover;
+        deflate.server_no_context_takeover = compression.server_no_context_takeover;
+        deflate.compLevel = compression.compression_level;
+        deflate.memLevel = compression.mem_level;
+        deflate.msg_size_threshold = compression.min_message_size;
+        ws_.set_option(deflate);
+    }
 
     return true;
 }
@@ -86,11 +184,18 @@ void BeastClient::CloseInternal(beast::error_code ec) {
 }
 
 void BeastClient::CompleteClose() {
+    // Frames held back by a batch go out ahead of the close frame
+    ws_.next_layer().ReleaseWrites();
+    // A streamed message waiting for its producer is aborted
+    if (stream_waiting_) {
+        PostStreamResume(stream_generation_);
+    }
+
     if (ws_.is_open()) {
         ws_.async_close(websocket::close_code::normal,
                         beast::bind_front_handler(&BeastClient::OnClose, shared_from_this()));
     } else {
-        net::post(ioc_,
+        net::post(ws_.get_executor(),
                   beast::bind_front_handler(&BeastClient::OnCloseInternal, shared_from_this()));
     }
 }
@@ -103,7 +208,11 @@ void BeastClient::OnConnect(beast::error_code ec, tcp::resolver::results_type::e
 
     beast::get_lowest_layer(ws_).expires_after(ASYNC_TIMEOUT);
 
-    ws_.next_layer().async_handshake(
+    // Offer a cached session so a reconnect can skip the full handshake
+    tls_context_->PrepareSessionResumption(GetTlsStream().native_handle(), session_key_);
+
+    phase_started_ = std::chrono::steady_clock::now();
+    GetTlsStream().async_handshake(
         ssl::stream_base::client,
         beast::bind_front_handler(&BeastClient::OnTlsHandshake, shared_from_this()));
 }
@@ -114,6 +223,11 @@ void BeastClient::OnTlsHandshake(beast::error_code ec) {
         return;
     }
 
+    const auto now = std::chrono::steady_clock::now();
+    callback_.OnConnectPhaseCompleted(ConnectPhase::TlsHandshake, now - phase_started_);
+    callback_.OnTlsHandshakeCompleted(SSL_session_reused(GetTlsStream().native_handle()) == 1);
+    phase_started_ = now;
+
     beast::get_lowest_layer(ws_).expires_never();
     ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
 
@@ -129,6 +243,8 @@ void BeastClient::OnHandshake(beast::error_code ec) {
         return;
     }
 
+    callback_.OnConnectPhaseCompleted(ConnectPhase::WebSocketHandshake,
+                                      std::chrono::steady_clock::now() - phase_started_);
     connection_state_.store(ConnectionState::Connected);
 
     callback_.OnConnected();
@@ -138,16 +254,50 @@ void BeastClient::OnHandshake(beast::error_code ec) {
 
 void BeastClient::OnRead(beast::error_code ec, std::size_t bytesRead) {
     assert(read_buffer_.size() == bytesRead);
+    read_in_progress_ = false;
 
     if (ec) {
         CloseInternal(ec);
         return;
     }
 
-    std::string message{ beast::buffers_to_string(read_buffer_.data()) };
+    // flat_buffer is contiguous, so the message is handed out as a view into the read buffer and
+    // only consumed once the callback has returned
+    const net::const_buffer data = read_buffer_.data();
+    callback_.OnMessageReceived(
+        std::string_view(static_cast<const char*>(data.data()), data.size()),
+        ws_.got_binary() ? MessageType::Binary : MessageType::Text);
     read_buffer_.consume(bytesRead);
 
-    callback_.OnMessageReceived(message);
+    PerformRead();
+}
+
+void BeastClient::OnReadSome(beast::error_code ec, std::size_t) {
+    if (ec) {
+        read_in_progress_ = false;
+        CloseInternal(ec);
+        return;
+    }
+
+    // A single read completes with whatever the last TLS record held; keep filling the chunk so
+    // fragments are not much smaller than requested
+    const size_t chunk_size = *connection_config_.streaming_receive_chunk_size;
+    const bool is_final = ws_.is_message_done();
+    if (!is_final && read_buffer_.size() < chunk_size) {
+        ws_.async_read_some(
+            read_buffer_, chunk_size - read_buffer_.size(),
+            beast::bind_front_handler(&BeastClient::OnReadSome, shared_from_this()));
+        return;
+    }
+
+    read_in_progress_ = false;
+
+    // The buffer only ever holds the current fragment, so its capacity stays at the chunk size
+    const net::const_buffer data = read_buffer_.data();
+    callback_.OnMessageFragmentReceived(
+        std::string_view(static_cast<const char*>(data.data()), data.size()),
+        ws_.got_binary() ? MessageType::Binary : MessageType::Text, is_final);
+    read_buffer_.consume(read_buffer_.size());
 
     PerformRead();
 }
@@ -161,6 +311,56 @@ void BeastClient::OnWrite(beast::error_code ec, std::size_t) {
     writer_callback_.OnMessageWriteCompleted(status);
 }
 
+void BeastClient::OnBatchFrameWrite(beast::error_code ec, std::size_t) {
+    if (ec) {
+        // Frames held before the failed one still go out, ahead of the close frame, unless the
+        // failure is the flush of the held frames, which only got some of them to TLS
+        size_t frames_written = next_batch_frame_;
+        if (next_batch_frame_ + 1 == batch_buffers_.size()) {
+            const size_t flushed = ws_.next_layer().GetLastFlushBytes();
+            frames_written = static_cast<size_t>(
+                std::upper_bound(batch_frame_ends_.begin(), batch_frame_ends_.end(), flushed) -
+                batch_frame_ends_.begin());
+        }
+
+        CloseInternal(ec);
+        if (frames_written > 0) {
+            writer_callback_.OnBatchPartiallyWritten(frames_written);
+        }
+        writer_callback_.OnMessageWriteCompleted(MessageWriteStatus::Failure);
+        return;
+    }
+
+    batch_frame_ends_.push_back(ws_.next_layer().GetHeldBytes());
+    if (++next_batch_frame_ < batch_buffers_.size()) {
+        WriteNextBatchFrame();
+        return;
+    }
+
+    writer_callback_.OnMessageWriteCompleted(MessageWriteStatus::Success);
+}
+
+void BeastClient::OnStreamFragmentWrite(beast::error_code ec, std::size_t bytes_written) {
+    if (ec) {
+        CloseInternal(ec);
+        std::exchange(stream_producer_, nullptr)->OnAborted();
+        writer_callback_.OnMessageWriteCompleted(MessageWriteStatus::Failure);
+        return;
+    }
+
+    stream_bytes_written_ += bytes_written;
+    writer_callback_.OnMessageFragmentWritten(bytes_written);
+    stream_producer_->OnProgress(stream_bytes_written_, stream_last_chunk_);
+
+    if (!stream_last_chunk_) {
+        WriteNextStreamFragment();
+        return;
+    }
+
+    stream_producer_.reset();
+    writer_callback_.OnMessageWriteCompleted(MessageWriteStatus::Success);
+}
+
 void BeastClient::OnClose(beast::error_code) { OnCloseInternal(); }
 
 void BeastClient::OnCloseInternal() {
@@ -173,10 +373,70 @@ void BeastClient::OnCloseInternal() {
 }
 
 void BeastClient::PerformRead() {
+    if (read_paused_) {
+        return;  // Picked up again by ResumeReading
+    }
+
+    read_in_progress_ = true;
+    if (connection_config_.streaming_receive_chunk_size) {
+        ws_.async_read_some(
+            read_buffer_, *connection_config_.streaming_receive_chunk_size,
+            beast::bind_front_handler(&BeastClient::OnReadSome, shared_from_this()));
+        return;
+    }
+
     ws_.async_read(read_buffer_,
                    beast::bind_front_handler(&BeastClient::OnRead, shared_from_this()));
 }
 
+void BeastClient::WriteNextBatchFrame() {
+    if (next_batch_frame_ + 1 < batch_buffers_.size()) {
+        ws_.next_layer().HoldWrites();
+    } else {
+        ws_.next_layer().ReleaseWrites();
+    }
+
+    ws_.async_write(batch_buffers_[next_batch_frame_],
+                    BindWriteMemory(beast::bind_front_handler(&BeastClient::OnBatchFrameWrite,
+                                                              shared_from_this())));
+}
+
+void BeastClient::WriteNextStreamFragment() {
+    if (should_stop_) {
+        OnStreamFragmentWrite(net::error::operation_aborted, 0);
+        return;
+    }
+
+    bool is_last = false;
+    const size_t chunk_bytes = stream_producer_->ReadChunk(stream_chunk_, is_last);
+    if (chunk_bytes == 0 && !is_last) {
+        stream_waiting_ = true;  // Until the producer has more data
+        return;
+    }
+
+    stream_last_chunk_ = is_last;
+    ws_.async_write_some(
+        is_last, net::buffer(stream_chunk_.data(), std::min(chunk_bytes, stream_chunk_.size())),
+        BindWriteMemory(beast::bind_front_handler(&BeastClient::OnStreamFragmentWrite,
+                                                  shared_from_this())));
+}
+
+void BeastClient::PostStreamResume(uint64_t generation) {
+    net::post(ws_.get_executor(),
+              BindWriteMemory([self = shared_from_this(), generation]() {
+                  self->ResumeStream(generation);
+              }));
+}
+
+void BeastClient::ResumeStream(uint64_t generation) {
+    if (!stream_waiting_ || generation != stream_generation_) {
+        return;
+    }
+
+    stream_waiting_ = false;
+    WriteNextStreamFragment();
+}
+
 ErrorDetails BeastClient::GetLastErrorForReporting() const {
     ErrorDetails error;
     if (last_error_) {
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <boost/asio/bind_allocator.hpp>
 #include <boost/beast/http.hpp>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
 
 #include "Implementation/Beast/Common.hpp"
 #include "Implementation/Beast/Connector/IConnector.hpp"
+#include "Implementation/Beast/Tls/TlsContext.hpp"
+#include "Implementation/Beast/WebSocketStream.hpp"
+#include "Implementation/Internal/BlockPool.hpp"
 #include "Implementation/Internal/ClientCallbackInterfaces.hpp"
 #include "Include/WebSocketMessenger.hpp"
 
@@ -17,15 +27,30 @@ class BeastClient : public std::enable_shared_from_this<BeastClient> {
         Disconnected,
     };
 
+    // Fits the operations a TLS write is made of; a connection has one write in flight
+    static constexpr size_t WriteBlockSize = 1024;
+    static constexpr size_t MaxFreeWriteBlocks = 8;
+
   public:
     explicit BeastClient(IWebSocketClientCallback& callback, IWriterOperator& writer_callback,
-                         const ServerSettings& settings, net::io_context& ioc, ssl::context& ctx);
+                         const ConnectionConfig& config, const StrandExecutor& executor,
+                         std::shared_ptr<TlsContext> tls_context,
+                         std::shared_ptr<void> lifetime_guard = nullptr);
     ~BeastClient();
 
     bool Open();
-    bool Send(std::string_view message);
+    bool Send(std::string_view message, MessageType type);
+    bool SendBatch(std::span<const std::string_view> messages, MessageType type,
+                   std::optional<std::string_view> delimiter);
+    bool SendStream(std::shared_ptr<IMessageStreamProducer> producer, MessageType type);
     void Close();
 
+    // Stops reading from the socket once the read in flight has completed, so the peer is held
+    // back by TCP flow control, until `ResumeReading`. Both must be called on the client's
+    // executor; a client may be paused before it is opened.
+    void PauseReading();
+    void ResumeReading();
+
     bool IsConnected() const;
 
   private:
@@ -39,12 +64,31 @@ class BeastClient : public std::enable_shared_from_this<BeastClient> {
     void OnTlsHandshake(beast::error_code ec);
     void OnHandshake(beast::error_code ec);
     void OnRead(beast::error_code ec, std::size_t bytes_read);
+    void OnReadSome(beast::error_code ec, std::size_t bytes_read);
     void OnWrite(beast::error_code ec, std::size_t);
+    void OnBatchFrameWrite(beast::error_code ec, std::size_t);
+    void OnStreamFragmentWrite(beast::error_code ec, std::size_t);
     void OnClose(beast::error_code);
 
     void OnCloseInternal();
 
     void PerformRead();
+    void WriteNextBatchFrame();
+    void WriteNextStreamFragment();
+    // Continues the streamed message `generation` if it is waiting for its producer. May be
+    // called from any thread.
+    void PostStreamResume(uint64_t generation);
+    void ResumeStream(uint64_t generation);
+
+    // Write operations draw their memory from `write_memory_`. Asio's per-thread cache only keeps
+    // a couple of blocks, which the strand's own bookkeeping keeps taking back from the writes.
+    template <typename HandlerT>
+    auto BindWriteMemory(HandlerT&& handler) {
+        return net::bind_allocator(BlockPoolAllocator<void>(write_memory_),
+                                   std::forward<HandlerT>(handler));
+    }
+
+    TlsStream& GetTlsStream() { return ws_.next_layer().next_layer(); }
 
     ErrorDetails GetLastErrorForReporting() const;
 
@@ -54,13 +98,33 @@ class BeastClient : public std::enable_shared_from_this<BeastClient> {
 
     std::shared_ptr<IConnector> connector_;
 
-    websocket::stream<ssl::stream<beast::tcp_stream>> ws_;
+    std::shared_ptr<TlsContext> tls_context_;
+    std::string session_key_;  // host:port the TLS session cache entry is kept under
+    BlockPool write_memory_{ WriteBlockSize, MaxFreeWriteBlocks };  // Outlives the stream's ops
+    WebSocketStream ws_;
     beast::flat_buffer read_buffer_;
+    bool read_in_progress_{ false };
+    bool read_paused_{ false };
+    // State of the batched write in flight; capacity is reused across batches
+    std::vector<net::const_buffer> batch_buffers_;
+    size_t next_batch_frame_{ 0 };
+    std::vector<size_t> batch_frame_ends_;  // Offset in the held bytes each held frame ends at
+    // State of the streamed message in flight; the chunk buffer is allocated on first use
+    std::shared_ptr<IMessageStreamProducer> stream_producer_;
+    std::vector<std::byte> stream_chunk_;
+    size_t stream_bytes_written_{ 0 };
+    bool stream_last_chunk_{ false };
+    bool stream_waiting_{ false };  // For the producer to have data
+    uint64_t stream_generation_{ 0 };  // Tells the producer's resume calls from older messages'
     std::optional<beast::error_code> last_error_;  // Last error encountered during operations
+    // Start of the TLS or WebSocket handshake in progress
+    std::chrono::steady_clock::time_point phase_started_;
 
     IWebSocketClientCallback& callback_;
     IWriterOperator& writer_callback_;
-    net::io_context& ioc_;
-    ServerSettings server_settings_;
+    const ConnectionConfig connection_config_;
+    const ServerSettings& server_settings_;
+    // Owner-supplied guard released when the client is destroyed, i.e. after its last handler ran
+    std::shared_ptr<void> lifetime_guard_;
 };
 }  // namespace WS
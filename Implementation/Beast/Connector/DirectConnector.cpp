@@ -1,12 +1,13 @@
 #include "Implementation/Beast/Connector/DirectConnector.hpp"
 
 namespace WS {
-DirectConnector::DirectConnector(net::io_context& ioc,
-                                 websocket::stream<ssl::stream<beast::tcp_stream>>& ws)
-    : resolver_(ioc), ws_(ws) {}
+DirectConnector::DirectConnector(const net::any_io_executor& executor, WebSocketStream& ws,
+                                 IWebSocketClientCallback& callback)
+    : resolver_(executor), ws_(ws), callback_(callback) {}
 
 void DirectConnector::Connect(const ServerSettings& settings, OnConnectCallback&& callback) {
     pending_connect_callback_ = std::move(callback);
+    phase_started_ = std::chrono::steady_clock::now();
 
     resolver_.async_resolve(
         settings.host, std::to_string(settings.port),
@@ -19,6 +20,10 @@ void DirectConnector::OnResolve(beast::error_code ec, tcp::resolver::results_typ
         return;
     }
 
+    const auto now = std::chrono::steady_clock::now();
+    callback_.OnConnectPhaseCompleted(ConnectPhase::Resolve, now - phase_started_);
+    phase_started_ = now;
+
     beast::get_lowest_layer(ws_).expires_after(ASYNC_TIMEOUT);
     beast::get_lowest_layer(ws_).async_connect(
         results, beast::bind_front_handler(&DirectConnector::OnConnect, shared_from_this()));
@@ -26,6 +31,10 @@ void DirectConnector::OnResolve(beast::error_code ec, tcp::resolver::results_typ
 
 void DirectConnector::OnConnect(beast::error_code ec,
                                 tcp::resolver::results_type::endpoint_type endpoint) {
+    if (!ec) {
+        callback_.OnConnectPhaseCompleted(ConnectPhase::TcpConnect,
+                                          std::chrono::steady_clock::now() - phase_started_);
+    }
     InvokeCallback(ec, endpoint);
 }
 
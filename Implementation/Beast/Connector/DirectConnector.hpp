@@ -1,14 +1,18 @@
 #pragma once
 
+#include <chrono>
+
 #include "Implementation/Beast/Common.hpp"
 #include "Implementation/Beast/Connector/IConnector.hpp"
+#include "Implementation/Beast/WebSocketStream.hpp"
+#include "Implementation/Internal/ClientCallbackInterfaces.hpp"
 #include "Include/WebSocketMessenger.hpp"
 
 namespace WS {
 class DirectConnector : public IConnector, public std::enable_shared_from_this<DirectConnector> {
   public:
-    explicit DirectConnector(net::io_context& ioc,
-                             websocket::stream<ssl::stream<beast::tcp_stream>>& ws);
+    explicit DirectConnector(const net::any_io_executor& executor, WebSocketStream& ws,
+                             IWebSocketClientCallback& callback);
 
     void Connect(const ServerSettings& settings, OnConnectCallback&& callback) override;
 
@@ -20,7 +24,9 @@ class DirectConnector : public IConnector, public std::enable_shared_from_this<D
 
   private:
     tcp::resolver resolver_;
-    websocket::stream<ssl::stream<beast::tcp_stream>>& ws_;
+    WebSocketStream& ws_;
+    IWebSocketClientCallback& callback_;
     OnConnectCallback pending_connect_callback_;
+    std::chrono::steady_clock::time_point phase_started_;
 };
 }  // namespace WS
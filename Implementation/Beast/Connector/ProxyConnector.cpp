@@ -3,9 +3,11 @@
 #include <boost/beast/core/detail/base64.hpp>
 
 namespace WS {
-ProxyConnector::ProxyConnector(net::io_context& ioc,
-                               websocket::stream<ssl::stream<beast::tcp_stream>>& ws)
-    : direct_connector_(std::make_shared<DirectConnector>(ioc, ws)), ws_(ws) {}
+ProxyConnector::ProxyConnector(const net::any_io_executor& executor, WebSocketStream& ws,
+                               IWebSocketClientCallback& callback)
+    : direct_connector_(std::make_shared<DirectConnector>(executor, ws, callback)),
+      ws_(ws),
+      callback_(callback) {}
 
 void ProxyConnector::Connect(const ServerSettings& settings, OnConnectCallback&& callback) {
     pending_connect_callback_ = std::move(callback);
@@ -30,6 +32,7 @@ void ProxyConnector::OnDirectConnect(beast::error_code ec,
         return;
     }
 
+    tunnel_started_ = std::chrono::steady_clock::now();
     beast::get_lowest_layer(ws_).expires_after(PROXY_HANDSHAKE_TIMEOUT);
 
     auto& request = proxy_request_.request;
@@ -75,6 +78,8 @@ void ProxyConnector::OnProxyResponse(beast::error_code ec, std::size_t) {
         return InvokeCallback(boost::system::errc::make_error_code(beast::errc::protocol_error));
     }
 
+    callback_.OnConnectPhaseCompleted(ConnectPhase::ProxyTunnel,
+                                      std::chrono::steady_clock::now() - tunnel_started_);
     InvokeCallback({});
 }
 std::string ProxyConnector::GetEncodedProxyAuth() const {
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <boost/beast/http.hpp>
+#include <chrono>
 
 #include "Implementation/Beast/Common.hpp"
 #include "Implementation/Beast/Connector/DirectConnector.hpp"
 #include "Implementation/Beast/Connector/IConnector.hpp"
+#include "Implementation/Beast/WebSocketStream.hpp"
+#include "Implementation/Internal/ClientCallbackInterfaces.hpp"
 #include "Include/WebSocketMessenger.hpp"
 
 namespace WS {
@@ -20,8 +23,8 @@ class ProxyConnector : public IConnector, public std::enable_shared_from_this<Pr
     };
 
   public:
-    explicit ProxyConnector(net::io_context& ioc,
-                            websocket::stream<ssl::stream<beast::tcp_stream>>& ws);
+    explicit ProxyConnector(const net::any_io_executor& executor, WebSocketStream& ws,
+                            IWebSocketClientCallback& callback);
 
     void Connect(const ServerSettings& settings, OnConnectCallback&& callback) override;
 
@@ -36,10 +39,12 @@ class ProxyConnector : public IConnector, public std::enable_shared_from_this<Pr
 
   private:
     std::shared_ptr<DirectConnector> direct_connector_;
-    websocket::stream<ssl::stream<beast::tcp_stream>>& ws_;
+    WebSocketStream& ws_;
+    IWebSocketClientCallback& callback_;
     ServerSettings server_settings_;
     OnConnectCallback pending_connect_callback_;
     ProxyRequest proxy_request_;
     ProxyResponse proxy_response_;
+    std::chrono::steady_clock::time_point tunnel_started_;
 };
 }  // namespace WS
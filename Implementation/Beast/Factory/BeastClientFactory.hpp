@@ -11,9 +11,13 @@ class BeastClientFactory {
 
     std::shared_ptr<WebSocketClientT> CreateClient(IWebSocketClientCallback& callback,
                                                    IWriterOperator& writer_callback,
-                                                   const ServerSettings& settings, net::io_context& ioc,
-                                                   ssl::context& ctx) {
-        return std::make_shared<WebSocketClientT>(callback, writer_callback, settings, ioc, ctx);
+                                                   const ConnectionConfig& config,
+                                                   const StrandExecutor& executor,
+                                                   std::shared_ptr<TlsContext> tls_context,
+                                                   std::shared_ptr<void> lifetime_guard) {
+        return std::make_shared<WebSocketClientT>(callback, writer_callback, config, executor,
+                                                  std::move(tls_context),
+                                                  std::move(lifetime_guard));
     }
 };
 }  // namespace WS
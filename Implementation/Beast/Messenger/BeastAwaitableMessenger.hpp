@@ -0,0 +1,225 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include "Implementation/Beast/Common.hpp"
+#include "Implementation/Beast/Messenger/BeastMessenger.hpp"
+#include "Include/AwaitableWebSocketMessenger.hpp"
+
+namespace WS {
+// Awaitable messenger on top of an Async BeastMessenger. Send completions are attached to the
+// queued messages and fire once the send policy is done with them; received messages are queued
+// here until a coroutine awaits them, and only then released for `receive_flow_control`.
+template <typename ClientFactoryT>
+class BeastAwaitableMessenger : public IAwaitableWebSocketMessenger,
+                                private IWebSocketMessengerCallback {
+  private:
+    using MessengerT = BeastMessenger<SendBehaviorInternal::Async, ClientFactoryT>;
+    using ReceiveCompletion = std::function<void(std::optional<ReceivedMessage>)>;
+    using SendHandler =
+        net::async_result<net::use_awaitable_t<>, void(MessageWriteStatus)>::handler_type;
+
+  public:
+    BeastAwaitableMessenger(IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+                            std::shared_ptr<BeastRuntime> runtime = nullptr)
+        : callback_(callback),
+          messenger_(std::make_unique<MessengerT>(static_cast<IWebSocketMessengerCallback&>(*this),
+                                                  config, nullptr, nullptr, std::move(runtime))) {
+        messenger_->EnableExplicitReceiveRelease();
+    }
+
+    ~BeastAwaitableMessenger() { Close(); }
+
+    // IAwaitableWebSocketMessenger
+    net::awaitable<MessageWriteStatus> AsyncSend(std::string message,
+                                                 SendOptions options) override {
+        // Kept in this coroutine's frame, which lives until the send completes, so the completion
+        // only carries a pointer to it and allocates nothing
+        std::optional<SendHandler> send_handler;
+        co_return co_await net::async_initiate<const net::use_awaitable_t<>&,
+                                               void(MessageWriteStatus)>(
+            [this, &options, &send_handler](SendHandler handler, std::string message) {
+                send_handler.emplace(std::move(handler));
+                auto complete = [&send_handler](MessageWriteStatus status) {
+                    CompleteSend(*send_handler, status);
+                };
+
+                OutgoingMessage outgoing{ std::move(message), options.type, nullptr, nullptr,
+                                          options.priority,
+                                          options.conflate ? options.key : std::nullopt,
+                                          options.deadline };
+                outgoing.on_written = complete;
+                if (messenger_->TrySend(std::move(outgoing)) != SendResult::Accepted) {
+                    complete(MessageWriteStatus::Failure);
+                }
+            },
+            net::use_awaitable, std::move(message));
+    }
+
+    net::awaitable<std::optional<ReceivedMessage>> AsyncReceive() override {
+        co_return co_await net::async_initiate<const net::use_awaitable_t<>&,
+                                               void(std::optional<ReceivedMessage>)>(
+            [this](auto handler) {
+                auto complete = MakeCompletion<std::optional<ReceivedMessage>>(std::move(handler));
+
+                std::unique_lock<std::mutex> lock(receive_mutex_);
+                if (!received_.empty()) {
+                    ReceivedMessage message = std::move(received_.front());
+                    received_.pop_front();
+                    lock.unlock();
+                    messenger_->ReleaseReceivedBytes(message.payload.size());
+                    complete(std::move(message));
+                } else if (receive_closed_) {
+                    lock.unlock();
+                    complete(std::nullopt);
+                } else {
+                    pending_receives_.push_back(std::move(complete));
+                }
+            },
+            net::use_awaitable);
+    }
+
+    // IWebSocketMessenger
+    bool Open() override { return messenger_->Open(); }
+
+    bool Send(std::string&& message, const SendOptions& options) override {
+        return messenger_->Send(std::move(message), options);
+    }
+
+    std::string AcquireSendBuffer(size_t capacity) override {
+        return messenger_->AcquireSendBuffer(capacity);
+    }
+
+    bool Send(std::span<const std::byte> message, const SendOptions& options) override {
+        return messenger_->Send(message, options);
+    }
+
+    bool Send(SharedPayload message, const SendOptions& options) override {
+        return messenger_->Send(std::move(message), options);
+    }
+
+    SendResult TrySend(std::string&& message, const SendOptions& options) override {
+        return messenger_->TrySend(std::move(message), options);
+    }
+
+    SendResult TrySend(SharedPayload message, const SendOptions& options) override {
+        return messenger_->TrySend(std::move(message), options);
+    }
+
+    SendResult SendStream(std::shared_ptr<IMessageStreamProducer> producer,
+                          const SendOptions& options) override {
+        return messenger_->SendStream(std::move(producer), options);
+    }
+
+    void PauseReceive() override { messenger_->PauseReceive(); }
+
+    void ResumeReceive() override { messenger_->ResumeReceive(); }
+
+    void Close() override {
+        messenger_->Close();
+
+        std::deque<ReceiveCompletion> pending_receives;
+        {
+            std::lock_guard<std::mutex> lock(receive_mutex_);
+            receive_closed_ = true;
+            pending_receives.swap(pending_receives_);
+        }
+        for (ReceiveCompletion& pending_receive : pending_receives) {
+            pending_receive(std::nullopt);
+        }
+    }
+
+    ConnectionStats GetConnectionStats() const override { return messenger_->GetConnectionStats(); }
+
+    LatencyStats GetLatencyStats() const override { return messenger_->GetLatencyStats(); }
+
+    bool ScheduleReconnect(std::optional<ServerSettings> settings) override {
+        return messenger_->ScheduleReconnect(std::move(settings));
+    }
+
+  private:
+    // IWebSocketMessengerCallback, invoked on the IO context
+    void OnMessageReceived(std::string_view message) override {
+        Deliver(ReceivedMessage{ std::string(message), MessageType::Text });
+    }
+
+    void OnBinaryMessageReceived(std::span<const std::byte> message) override {
+        Deliver(ReceivedMessage{
+            std::string(reinterpret_cast<const char*>(message.data()), message.size()),
+            MessageType::Binary });
+    }
+
+    void OnMessageFragment(std::string_view fragment, MessageType type, bool is_final) override {
+        callback_.OnMessageFragment(fragment, type, is_final);
+        messenger_->ReleaseReceivedBytes(fragment.size());
+    }
+
+    void OnMessageExpired(std::string_view message, MessageType type) override {
+        callback_.OnMessageExpired(message, type);
+    }
+
+    void OnConnected() override { callback_.OnConnected(); }
+    void OnDisconnected(const ErrorDetails& error) override { callback_.OnDisconnected(error); }
+    void SignalCriticalFailure() override { callback_.SignalCriticalFailure(); }
+
+    void Deliver(ReceivedMessage&& message) {
+        ReceiveCompletion pending_receive;
+        {
+            std::lock_guard<std::mutex> lock(receive_mutex_);
+            if (pending_receives_.empty()) {
+                received_.push_back(std::move(message));
+                return;
+            }
+            pending_receive = std::move(pending_receives_.front());
+            pending_receives_.pop_front();
+        }
+        messenger_->ReleaseReceivedBytes(message.payload.size());
+        pending_receive(std::move(message));
+    }
+
+    // Wraps an awaitable's completion handler into a copyable function that resumes the awaiting
+    // coroutine on its own executor. It must be invoked exactly once.
+    template <typename ResultT, typename HandlerT>
+    static std::function<void(ResultT)> MakeCompletion(HandlerT&& handler) {
+        auto shared_handler = std::make_shared<std::decay_t<HandlerT>>(std::move(handler));
+        return [shared_handler](ResultT result) {
+            const auto executor = net::get_associated_executor(*shared_handler);
+            net::post(executor, [shared_handler, result = std::move(result)]() mutable {
+                std::move(*shared_handler)(std::move(result));
+            });
+        };
+    }
+
+    // Resumes the coroutine awaiting a send on its own executor
+    static void CompleteSend(SendHandler& handler, MessageWriteStatus status) {
+        const auto executor = net::get_associated_executor(handler);
+        net::post(executor, [&handler, status]() {
+            // Moved out first, since resuming the coroutine destroys the frame holding it
+            SendHandler resume = std::move(handler);
+            std::move(resume)(status);
+        });
+    }
+
+  private:
+    IWebSocketMessengerCallback& callback_;
+
+    std::mutex receive_mutex_;
+    std::deque<ReceivedMessage> received_;
+    std::deque<ReceiveCompletion> pending_receives_;  // In the order the receives were started
+    bool receive_closed_{ false };
+
+    // Declared last so it is closed and destroyed before the receive state its callbacks use
+    std::unique_ptr<MessengerT> messenger_;
+};
+}  // namespace WS
@@ -6,15 +6,30 @@
 #include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <string>
 #include <thread>
 
+#include <boost/asio/bind_allocator.hpp>
+
 #include "Implementation/Beast/Common.hpp"
 #include "Implementation/Beast/Factory/BeastClientFactory.hpp"
+#include "Implementation/Beast/Runtime/BeastRuntime.hpp"
 #include "Implementation/Beast/SendPolicy/AsyncSendPolicy.hpp"
+#include "Implementation/Beast/SendPolicy/BatchSendPolicy.hpp"
 #include "Implementation/Beast/SendPolicy/BeastSendPolicy.hpp"
+#include "Implementation/Beast/SendPolicy/PipelinedSyncSendPolicy.hpp"
 #include "Implementation/Beast/SendPolicy/SyncSendPolicy.hpp"
+#include "Implementation/Beast/Tls/TlsContext.hpp"
+#include "Implementation/Internal/BlockPool.hpp"
+#include "Implementation/Internal/BufferPool.hpp"
 #include "Implementation/Internal/ClientCallbackInterfaces.hpp"
+#include "Implementation/Internal/ClientCallbackRelay.hpp"
+#include "Implementation/Internal/LatencyHistogram.hpp"
+#include "Implementation/Internal/ShardedCounters.hpp"
+#include "Implementation/Internal/SpscRingBuffer.hpp"
+#include "Implementation/Internal/WorkTracker.hpp"
 #include "Include/WebSocketMessenger.hpp"
 
 namespace WS {
@@ -26,34 +41,137 @@ class BeastMessenger : public IWebSocketMessenger,
   private:
     using WebSocketClientT = typename ClientFactoryT::WebSocketClientT;
 
-    struct ConnectionStatsInternal {
-        std::atomic<size_t> total_messages_sent{ 0 };
-        std::atomic<size_t> total_messages_received{ 0 };
-        std::atomic<size_t> total_bytes_sent{ 0 };
-        std::atomic<size_t> total_bytes_received{ 0 };
-        std::atomic<size_t> current_send_queue_size{ 0 };
+    enum class StatCounter {
+        MessagesSent,
+        MessagesReceived,
+        BytesSent,
+        BytesReceived,
+        SendQueueSize,
+        MessagesDropped,
+        MessagesRejected,
+        MessagesConflated,
+        MessagesExpired,
+        TlsHandshakes,
+        TlsSessionsResumed,
+        WireBytesSent,
+        WireBytesReceived,
+        ReceiveQueueSize,
+        ReceivedMessagesDropped,
+        ReceivePauses,
+        // SendPriorityCount counters each, one per priority in its order
+        SendQueueSizeByPriority,
+        MessagesDroppedByPriority = SendQueueSizeByPriority + SendPriorityCount,
+        Count = MessagesDroppedByPriority + SendPriorityCount,
+    };
+
+    static StatCounter ForPriority(StatCounter first, SendPriority priority) {
+        return static_cast<StatCounter>(static_cast<size_t>(first) +
+                                        static_cast<size_t>(priority));
+    }
+
+    // Reading from the socket is paused while any of these is set
+    enum ReceivePauseReason : uint8_t {
+        PausedByUser = 1 << 0,
+        PausedByDispatchQueue = 1 << 1,
+        PausedByWatermark = 1 << 2,
+    };
+
+    // A received message or fragment waiting for the dispatch executor
+    struct DispatchedMessage {
+        std::string payload;
+        MessageType type{ MessageType::Text };
+        bool is_fragment{ false };
+        bool is_final{ true };
     };
 
   public:
+    struct LatencyStatsInternal {
+        LatencyHistogram queue_wait;
+        LatencyHistogram write;
+        LatencyHistogram dns_resolve;
+        LatencyHistogram tcp_connect;
+        LatencyHistogram proxy_tunnel;
+        LatencyHistogram tls_handshake;
+        LatencyHistogram websocket_handshake;
+
+        void Merge(const LatencyStatsInternal& other) {
+            queue_wait.Merge(other.queue_wait);
+            write.Merge(other.write);
+            dns_resolve.Merge(other.dns_resolve);
+            tcp_connect.Merge(other.tcp_connect);
+            proxy_tunnel.Merge(other.proxy_tunnel);
+            tls_handshake.Merge(other.tls_handshake);
+            websocket_handshake.Merge(other.websocket_handshake);
+        }
+
+        LatencyStats GetPercentiles() const {
+            LatencyStats stats;
+            stats.queue_wait = queue_wait.GetPercentiles();
+            stats.write = write.GetPercentiles();
+            stats.dns_resolve = dns_resolve.GetPercentiles();
+            stats.tcp_connect = tcp_connect.GetPercentiles();
+            stats.proxy_tunnel = proxy_tunnel.GetPercentiles();
+            stats.tls_handshake = tls_handshake.GetPercentiles();
+            stats.websocket_handshake = websocket_handshake.GetPercentiles();
+            return stats;
+        }
+    };
+
     BeastMessenger(IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
                    std::shared_ptr<ClientFactoryT> factory = nullptr,
-                   std::shared_ptr<ISendPolicyFactory> send_policy_factory = nullptr)
-        : messenger_callback_(callback),
+                   std::shared_ptr<ISendPolicyFactory> send_policy_factory = nullptr,
+                   std::shared_ptr<BeastRuntime> runtime = nullptr)
+        // Without a shared runtime the messenger gets a private single-thread one
+        : runtime_(runtime ? std::move(runtime) : std::make_shared<BeastRuntime>(1)),
+          strand_(net::make_strand(runtime_->AcquireContext())),
+          handler_memory_(runtime_->GetHandlerMemory(strand_.get_inner_executor().context())),
+          messenger_callback_(callback),
           connection_config_(config),
+          send_buffers_(config.send_buffer_pool.max_buffers,
+                        config.send_buffer_pool.max_buffer_capacity),
           client_factory_(std::move(factory)),
-          work_guard_(),
-          ioc_(),
-          ctx_(ssl::context::tlsv13_client),
-          context_thread_(),
+          client_callbacks_(std::make_shared<ClientCallbackRelay>(*this, *this)),
           client_(),
           reconnect_attempts_(0) {
         if (!client_factory_) {
             client_factory_ = std::make_shared<ClientFactoryT>();
         }
         InitializeSendPolicy(send_policy_factory);
+
+        if (connection_config_.receive_dispatch.executor) {
+            if (connection_config_.receive_dispatch.queue_capacity == 0) {
+                throw std::invalid_argument("Receive dispatch queue capacity must not be zero");
+            }
+            dispatch_queue_ = std::make_unique<SpscRingBuffer<DispatchedMessage>>(
+                connection_config_.receive_dispatch.queue_capacity);
+        }
+
+        const auto& flow_control = connection_config_.receive_flow_control;
+        if (flow_control.high_watermark_bytes != 0 &&
+            flow_control.low_watermark_bytes >= flow_control.high_watermark_bytes) {
+            throw std::invalid_argument("Receive low watermark must be below the high watermark");
+        }
     }
 
-    ~BeastMessenger() { Close(); }
+    ~BeastMessenger() {
+        Close();
+
+        if (!IsInContextThread() && dispatch_thread_.load() == std::this_thread::get_id()) {
+            // Destroyed from a dispatch task, which Close cannot wait for and which may run
+            // alongside the messenger's handlers, so finish on the strand
+            std::promise<void> finalized;
+            net::post(strand_, [this, &finalized]() {
+                Finalize();
+                finalized.set_value();
+            });
+            finalized.get_future().wait();
+            return;
+        }
+
+        // Either Close has waited for all work, or this is the IO thread, on which none of it can
+        // run meanwhile
+        Finalize();
+    }
 
     // IWebSocketMessenger
     bool Open() override {
@@ -64,38 +182,160 @@ class BeastMessenger : public IWebSocketMessenger,
         return true;
     }
 
-    bool Send(std::string&& message) override {
+    std::string AcquireSendBuffer(size_t capacity) override {
+        return send_buffers_.Acquire(capacity);
+    }
+
+    bool Send(std::string&& message, const SendOptions& options) override {
+        return TrySend(std::move(message), options) == SendResult::Accepted;
+    }
+
+    bool Send(std::span<const std::byte> message, const SendOptions& options) override {
+        std::string payload = send_buffers_.Acquire(message.size());
+        payload.assign(reinterpret_cast<const char*>(message.data()), message.size());
+        return TrySend(std::move(payload), options) == SendResult::Accepted;
+    }
+
+    bool Send(SharedPayload message, const SendOptions& options) override {
+        return TrySend(std::move(message), options) == SendResult::Accepted;
+    }
+
+    SendResult TrySend(std::string&& message, const SendOptions& options) override {
+        return TrySend(OutgoingMessage{ std::move(message), options.type, nullptr, nullptr,
+                                        options.priority, ConflationKey(options),
+                                        options.deadline });
+    }
+
+    SendResult TrySend(SharedPayload message, const SendOptions& options) override {
+        if (!message) {
+            return SendResult::Rejected;
+        }
+        return TrySend(OutgoingMessage{ {}, options.type, std::move(message), nullptr,
+                                        options.priority, ConflationKey(options),
+                                        options.deadline });
+    }
+
+    SendResult SendStream(std::shared_ptr<IMessageStreamProducer> producer,
+                          const SendOptions& options) override {
+        if (!producer) {
+            return SendResult::Rejected;
+        }
+        return TrySend(OutgoingMessage{ {}, options.type, nullptr, std::move(producer),
+                                        options.priority, std::nullopt, options.deadline });
+    }
+
+    const LatencyStatsInternal& GetLatencyHistograms() const { return latency_stats_; }
+
+    size_t GetSendQueueSize() const { return stats_.Load(StatCounter::SendQueueSize); }
+
+    // Keeps the send queue size in a single gauge as well, which a pool balancing on it reads far
+    // more cheaply than the sharded counter. Called before the messenger is opened.
+    void TrackQueuedMessages() { track_queued_messages_ = true; }
+
+    size_t GetQueuedMessages() const { return queued_messages_.load(std::memory_order_relaxed); }
+
+    // Derives the compression ratios from the byte totals
+    static void SetCompressionRatios(ConnectionStats& stats) {
+        if (stats.total_wire_bytes_sent > 0) {
+            stats.send_compression_ratio = static_cast<double>(stats.total_bytes_sent) /
+                                           static_cast<double>(stats.total_wire_bytes_sent);
+        }
+        if (stats.total_wire_bytes_received > 0) {
+            stats.receive_compression_ratio = static_cast<double>(stats.total_bytes_received) /
+                                              static_cast<double>(stats.total_wire_bytes_received);
+        }
+    }
+
+    // Received messages normally count as processed once their callback has returned. After this
+    // they only do once `ReleaseReceivedBytes` is called for them, for owners that buffer received
+    // messages themselves. Must be called before Open.
+    void EnableExplicitReceiveRelease() { explicit_receive_release_ = true; }
+
+    // Counts `bytes` of received messages as processed for `receive_flow_control`, and resumes
+    // reading once the low watermark is reached. May be called from any thread.
+    void ReleaseReceivedBytes(size_t bytes) {
+        if (!TracksUnprocessedReceiveBytes()) {
+            return;
+        }
+
+        const size_t unprocessed = unprocessed_receive_bytes_.fetch_sub(bytes) - bytes;
+        if (unprocessed <= connection_config_.receive_flow_control.low_watermark_bytes &&
+            watermark_paused_.load() && !watermark_check_posted_.exchange(true)) {
+            Post([this]() {
+                watermark_check_posted_.store(false);
+                CheckWatermarkResume();
+            });
+        }
+    }
+
+    // Hands a message to the send policy. Unless it is accepted, the message is left untouched.
+    SendResult TrySend(OutgoingMessage&& message) {
         if (stop_requested_ || !send_policy_) {
-            return false;
+            return SendResult::Rejected;
         }
         return send_policy_->Send(std::move(message));
     }
 
+    void PauseReceive() override {
+        if (!stop_requested_) {
+            Post([this]() { SetReceivePaused(PausedByUser, true); });
+        }
+    }
+
+    void ResumeReceive() override {
+        if (!stop_requested_) {
+            Post([this]() { SetReceivePaused(PausedByUser, false); });
+        }
+    }
+
     void Close() override {
         stop_requested_ = true;
 
-        net::post(ioc_, [this]() { CloseInternal(); });
+        Post([this]() { CloseInternal(); });
 
-        if (work_guard_) {
-            work_guard_->reset();  // signal work guard there is no more work to do
-            work_guard_.reset();
+        // The IO threads may be shared with other messengers, so instead of joining them wait
+        // until every handler referencing this messenger has run, including the closing client's.
+        // On an IO thread or in a dispatch task that would wait for handlers which cannot run
+        // meanwhile, so there the connection finishes closing in the background.
+        if (IsInContextThread() || dispatch_thread_.load() == std::this_thread::get_id()) {
+            return;
         }
 
-        if (context_thread_.joinable() && std::this_thread::get_id() != context_thread_.get_id()) {
-            context_thread_.join();
-        }
+        work_tracker_->WaitForIdle();
     }
 
     ConnectionStats GetConnectionStats() const override {
         ConnectionStats stats;
-        stats.total_messages_sent = stats_.total_messages_sent.load();
-        stats.total_messages_received = stats_.total_messages_received.load();
-        stats.total_bytes_sent = stats_.total_bytes_sent.load();
-        stats.total_bytes_received = stats_.total_bytes_received.load();
-        stats.current_send_queue_size = stats_.current_send_queue_size.load();
+        stats.total_messages_sent = stats_.Load(StatCounter::MessagesSent);
+        stats.total_messages_received = stats_.Load(StatCounter::MessagesReceived);
+        stats.total_bytes_sent = stats_.Load(StatCounter::BytesSent);
+        stats.total_bytes_received = stats_.Load(StatCounter::BytesReceived);
+        stats.current_send_queue_size = stats_.Load(StatCounter::SendQueueSize);
+        stats.total_messages_dropped = stats_.Load(StatCounter::MessagesDropped);
+        for (size_t i = 0; i < SendPriorityCount; ++i) {
+            const auto priority = static_cast<SendPriority>(i);
+            stats.current_send_queue_size_by_priority[i] =
+                stats_.Load(ForPriority(StatCounter::SendQueueSizeByPriority, priority));
+            stats.total_messages_dropped_by_priority[i] =
+                stats_.Load(ForPriority(StatCounter::MessagesDroppedByPriority, priority));
+        }
+        stats.total_messages_rejected = stats_.Load(StatCounter::MessagesRejected);
+        stats.total_messages_conflated = stats_.Load(StatCounter::MessagesConflated);
+        stats.total_messages_expired = stats_.Load(StatCounter::MessagesExpired);
+        stats.total_tls_handshakes = stats_.Load(StatCounter::TlsHandshakes);
+        stats.total_tls_sessions_resumed = stats_.Load(StatCounter::TlsSessionsResumed);
+        stats.total_wire_bytes_sent = stats_.Load(StatCounter::WireBytesSent);
+        stats.total_wire_bytes_received = stats_.Load(StatCounter::WireBytesReceived);
+        stats.current_receive_queue_size = stats_.Load(StatCounter::ReceiveQueueSize);
+        stats.total_received_messages_dropped = stats_.Load(StatCounter::ReceivedMessagesDropped);
+        stats.total_receive_pauses = stats_.Load(StatCounter::ReceivePauses);
+        stats.current_unprocessed_receive_bytes = unprocessed_receive_bytes_.load();
+        SetCompressionRatios(stats);
         return stats;
     }
 
+    LatencyStats GetLatencyStats() const override { return latency_stats_.GetPercentiles(); }
+
     bool ScheduleReconnect(std::optional<ServerSettings> settings) override {
         if (stop_requested_) {
             return false;
@@ -107,20 +347,74 @@ class BeastMessenger : public IWebSocketMessenger,
             return false;
         }
 
-        net::post(ioc_,
-                  [this, settings = std::move(settings)] { StartReconnectInternal(settings); });
+        Post([this, settings = std::move(settings)] { StartReconnectInternal(settings); });
         return true;
     }
 
     // IWebSocketClientCallbackV2
-    void OnMessageReceived(std::string_view message) override {
-        stats_.total_messages_received++;
-        stats_.total_bytes_received += message.size();
-        messenger_callback_.OnMessageReceived(message);
+    void OnMessageReceived(std::string_view message, MessageType type) override {
+        stats_.Add(StatCounter::MessagesReceived);
+        stats_.Add(StatCounter::BytesReceived, static_cast<int64_t>(message.size()));
+        AddUnprocessedReceiveBytes(message.size());
+        if (dispatch_queue_) {
+            Dispatch(DispatchedMessage{ std::string(message), type });
+            return;
+        }
+        DeliverMessage(messenger_callback_, message, type);
+    }
+
+    void OnMessageFragmentReceived(std::string_view fragment, MessageType type,
+                                   bool is_final) override {
+        if (is_final) {
+            stats_.Add(StatCounter::MessagesReceived);
+        }
+        stats_.Add(StatCounter::BytesReceived, static_cast<int64_t>(fragment.size()));
+        AddUnprocessedReceiveBytes(fragment.size());
+        if (dispatch_queue_) {
+            Dispatch(DispatchedMessage{ std::string(fragment), type, true, is_final });
+            return;
+        }
+        messenger_callback_.OnMessageFragment(fragment, type, is_final);
+    }
+
+    void OnTlsHandshakeCompleted(bool session_resumed) override {
+        stats_.Add(StatCounter::TlsHandshakes);
+        if (session_resumed) {
+            stats_.Add(StatCounter::TlsSessionsResumed);
+        }
+    }
+
+    void OnConnectPhaseCompleted(ConnectPhase phase, std::chrono::nanoseconds duration) override {
+        switch (phase) {
+            case ConnectPhase::Resolve:
+                latency_stats_.dns_resolve.Record(duration);
+                break;
+            case ConnectPhase::TcpConnect:
+                latency_stats_.tcp_connect.Record(duration);
+                break;
+            case ConnectPhase::ProxyTunnel:
+                latency_stats_.proxy_tunnel.Record(duration);
+                break;
+            case ConnectPhase::TlsHandshake:
+                latency_stats_.tls_handshake.Record(duration);
+                break;
+            case ConnectPhase::WebSocketHandshake:
+                latency_stats_.websocket_handshake.Record(duration);
+                break;
+        }
     }
 
     void OnConnected() override {
+        // A message cut off by the previous connection is not continued by this one
+        in_fragmented_message_ = false;
+        dropping_fragments_ = false;
+
+        const std::shared_ptr<WorkTracker> tracker = work_tracker_;
         messenger_callback_.OnConnected();
+        if (tracker->IsExpired()) {
+            return;  // Destroyed by the callback
+        }
+
         reconnect_attempts_ = 0;
         if (send_policy_) {
             send_policy_->OnConnected();
@@ -128,10 +422,22 @@ class BeastMessenger : public IWebSocketMessenger,
     }
 
     void OnDisconnected(const ErrorDetails& error) override {
+        const std::shared_ptr<WorkTracker> tracker = work_tracker_;
         messenger_callback_.OnDisconnected(error);
+        if (tracker->IsExpired()) {
+            return;  // Destroyed by the callback
+        }
+
         WaitAndReconnect();
     }
 
+    void OnWireBytesRead(size_t bytes) override {
+        stats_.Add(StatCounter::WireBytesReceived, static_cast<int64_t>(bytes));
+    }
+    void OnWireBytesWritten(size_t bytes) override {
+        stats_.Add(StatCounter::WireBytesSent, static_cast<int64_t>(bytes));
+    }
+
     // IWriterOperator
     void OnMessageWriteCompleted(MessageWriteStatus status) override {
         if (send_policy_) {
@@ -139,25 +445,91 @@ class BeastMessenger : public IWebSocketMessenger,
         }
     }
 
+    void OnBatchPartiallyWritten(size_t messages_written) override {
+        if (send_policy_) {
+            send_policy_->OnBatchPartiallyWritten(messages_written);
+        }
+    }
+
+    void OnMessageFragmentWritten(size_t bytes) override {
+        stats_.Add(StatCounter::BytesSent, static_cast<int64_t>(bytes));
+    }
+
     // ISendPolicyContext
     bool IsClientConnected() const override { return client_ && client_->IsConnected(); }
     bool HasClient() const override { return static_cast<bool>(client_); }
-    bool IsReadyForSynchronousSend() const override {
-        return context_thread_.joinable() && HasClient();
-    }
+    bool IsReadyForSynchronousSend() const override { return is_open_ && HasClient(); }
+    // True on the thread running this messenger's io_context, which may be shared with other
+    // messengers; blocking there would stall this messenger's handlers
     bool IsInContextThread() const override {
-        return std::this_thread::get_id() == context_thread_.get_id();
+        return strand_.get_inner_executor().running_in_this_thread();
     }
     size_t GetMaxSendQueueSize() const override { return connection_config_.max_send_queue_size; }
-    void PostToIOContext(std::function<void()> fn) override { net::post(ioc_, std::move(fn)); }
-    bool ClientSend(const std::string& message) override {
-        return client_ ? client_->Send(message) : false;
+    OverflowPolicy GetOverflowPolicy() const override {
+        return connection_config_.send_queue_overflow_policy;
+    }
+    std::chrono::milliseconds GetSendQueueBlockTimeout() const override {
+        return connection_config_.send_queue_block_timeout;
+    }
+    std::optional<std::chrono::milliseconds> GetSendTtl() const override {
+        return connection_config_.send_ttl;
+    }
+    const SendLaneSettings& GetSendLaneSettings() const override {
+        return connection_config_.send_lanes;
+    }
+    const BatchSettings& GetBatchSettings() const override {
+        return connection_config_.batch_settings;
+    }
+    const SyncSendSettings& GetSyncSendSettings() const override {
+        return connection_config_.sync_send_settings;
+    }
+    void PostToIOContext(std::function<void()> fn) override { Post(std::move(fn)); }
+    bool ClientSend(const OutgoingMessage& message) override {
+        if (!client_) {
+            return false;
+        }
+        return message.stream ? client_->SendStream(message.stream, message.type)
+                              : client_->Send(message.View(), message.type);
+    }
+    bool ClientSendBatch(std::span<const std::string_view> messages, MessageType type,
+                         std::optional<std::string_view> delimiter) override {
+        return client_ ? client_->SendBatch(messages, type, delimiter) : false;
+    }
+    void IncrementCurrentQueueSize(SendPriority priority) override {
+        stats_.Add(StatCounter::SendQueueSize);
+        stats_.Add(ForPriority(StatCounter::SendQueueSizeByPriority, priority));
+        if (track_queued_messages_) {
+            queued_messages_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void DecrementCurrentQueueSize(SendPriority priority) override {
+        stats_.Subtract(StatCounter::SendQueueSize);
+        stats_.Subtract(ForPriority(StatCounter::SendQueueSizeByPriority, priority));
+        if (track_queued_messages_) {
+            queued_messages_.fetch_sub(1, std::memory_order_relaxed);
+        }
     }
-    void IncrementCurrentQueueSize() override { stats_.current_send_queue_size++; }
-    void DecrementCurrentQueueSize() override { stats_.current_send_queue_size--; }
     void RecordMessageSent(size_t message_size_bytes) override {
-        stats_.total_messages_sent++;
-        stats_.total_bytes_sent += message_size_bytes;
+        stats_.Add(StatCounter::MessagesSent);
+        stats_.Add(StatCounter::BytesSent, static_cast<int64_t>(message_size_bytes));
+    }
+    void RecordMessageLatency(std::chrono::nanoseconds queue_wait,
+                              std::chrono::nanoseconds write_duration) override {
+        latency_stats_.queue_wait.Record(queue_wait);
+        latency_stats_.write.Record(write_duration);
+    }
+    void RecordMessageDropped(SendPriority priority) override {
+        stats_.Add(StatCounter::MessagesDropped);
+        stats_.Add(ForPriority(StatCounter::MessagesDroppedByPriority, priority));
+    }
+    void RecordMessageRejected() override { stats_.Add(StatCounter::MessagesRejected); }
+    void RecordMessageConflated() override { stats_.Add(StatCounter::MessagesConflated); }
+    void RecordMessageExpired(const OutgoingMessage& message) override {
+        stats_.Add(StatCounter::MessagesExpired);
+        messenger_callback_.OnMessageExpired(message.View(), message.type);
+    }
+    void RecyclePayload(std::string&& payload) override {
+        send_buffers_.Release(std::move(payload));
     }
 
   private:
@@ -179,6 +551,10 @@ class BeastMessenger : public IWebSocketMessenger,
                 send_policy_ = std::make_shared<SyncSendPolicy>(*this);
             } else if constexpr (SendBehaviorT == SendBehaviorInternal::Async) {
                 send_policy_ = std::make_shared<AsyncSendPolicy>(*this);
+            } else if constexpr (SendBehaviorT == SendBehaviorInternal::Batched) {
+                send_policy_ = std::make_shared<BatchSendPolicy>(*this);
+            } else if constexpr (SendBehaviorT == SendBehaviorInternal::PipelinedSync) {
+                send_policy_ = std::make_shared<PipelinedSyncSendPolicy>(*this);
             } else {
                 static_assert(always_false<SendBehaviorT>,
                               "Unsupported SendBehaviorT specified for BeastMessenger");
@@ -187,42 +563,21 @@ class BeastMessenger : public IWebSocketMessenger,
     }
 
     bool OpenInternal() {
-        if (!InitializeTlsContext()) {
-            return false;
+        // Trust anchors are loaded once per process (or runtime) and the session cache is shared
+        tls_context_ = runtime_->GetTlsContext();
+        if (!tls_context_) {
+            tls_context_ = TlsContext::GetDefault();
         }
-
-        work_guard_ =
-            std::make_unique<boost::asio::executor_work_guard<net::io_context::executor_type>>(
-                net::make_work_guard(ioc_));
-        reconnect_timer_ = std::make_unique<boost::asio::steady_timer>(ioc_);
-        context_thread_ = std::thread([this]() { RunIOContext(); });
-
-        if (!CreateAndOpenClient()) {
+        if (!tls_context_) {
             return false;
         }
 
-        return true;
-    }
+        reconnect_timer_ = std::make_unique<boost::asio::steady_timer>(strand_);
+        is_open_ = true;
 
-    bool InitializeTlsContext() {
-        boost::system::error_code ec;
-        ctx_.set_verify_mode(ssl::verify_peer, ec);
-        if (ec) {
-            return false;
-        }
-
-#if _WIN32 || _WIN64
-        if (::SSL_CTX_load_verify_store(ctx_.native_handle(), "org.openssl.winstore://") == 0) {
-            return false;
-        }
-#else
-        // TODO: Make sure this works on non-Debian systems that have CA certs injected as env
-        // variable
-        ctx_.set_default_verify_paths(ec);
-        if (ec) {
+        if (!CreateAndOpenClient()) {
             return false;
         }
-#endif
 
         return true;
     }
@@ -234,8 +589,22 @@ class BeastMessenger : public IWebSocketMessenger,
 
         last_reconnect_attempt_ = std::chrono::steady_clock::now();
 
-        client_ = client_factory_->CreateClient(*this, *this, connection_config_.server_settings,
-                                                ioc_, ctx_);
+        // The guard is released when the client is destroyed, i.e. once its last pending handler
+        // has run, which is what Close() waits for. It also keeps the relay the client calls the
+        // messenger through alive.
+        work_tracker_->Add();
+        std::shared_ptr<void> lifetime_guard(
+            nullptr,
+            [tracker = work_tracker_, relay = client_callbacks_](void*) { tracker->Remove(); });
+
+        client_ = client_factory_->CreateClient(*client_callbacks_, *client_callbacks_,
+                                                connection_config_, strand_, tls_context_,
+                                                std::move(lifetime_guard));
+
+        // Reading stays paused across reconnects
+        if (receive_pause_reasons_ != 0) {
+            client_->PauseReading();
+        }
 
         if (!client_->Open()) {
             return false;
@@ -244,7 +613,29 @@ class BeastMessenger : public IWebSocketMessenger,
         return true;
     }
 
-    void RunIOContext() { ioc_.run(); }
+    template <typename FunctionT>
+    void Post(FunctionT&& fn) {
+        work_tracker_->Add();
+        // `fn` may destroy the messenger, so the handler does not touch it afterwards
+        auto handler = [tracker = work_tracker_, fn = std::forward<FunctionT>(fn)]() mutable {
+            if (!tracker->IsExpired()) {
+                fn();
+            }
+            tracker->Remove();
+        };
+        // Mostly posted from other threads, whose handler memory Asio's per-thread cache would
+        // only free on the IO thread instead of reusing it
+        net::post(strand_, net::bind_allocator(BlockPoolAllocator<void>(handler_memory_),
+                                               std::move(handler)));
+    }
+
+    // Cuts the messenger off from the client and the handlers that may outlive it. Only called where
+    // none of the messenger's handlers can run at the same time.
+    void Finalize() {
+        client_callbacks_->Detach();
+        CloseInternal();
+        work_tracker_->Expire();
+    }
 
     void CloseInternal() {
         if (client_) {
@@ -307,41 +698,275 @@ class BeastMessenger : public IWebSocketMessenger,
         }
 
         reconnect_timer_->expires_after(wait_duration);
-        reconnect_timer_->async_wait(beast::bind_front_handler(&BeastMessenger::OnReconnect, this));
+        work_tracker_->Add();
+        reconnect_timer_->async_wait(
+            [this, tracker = work_tracker_](const boost::system::error_code& ec) {
+                if (!tracker->IsExpired()) {
+                    OnReconnect(ec);
+                }
+                tracker->Remove();
+            });
     }
 
     void OnReconnect(const boost::system::error_code& ec) {
-        if (ec == boost::asio::error::operation_aborted) {
-            return;
+        if (ec != boost::asio::error::operation_aborted) {
+            HandleReconnect();
         }
-
-        HandleReconnect();
     }
 
     bool IsCriticalFailureThresholdBreached() const {
         return reconnect_attempts_ > connection_config_.critical_failure_threshold;
     }
 
+    static std::optional<uint64_t> ConflationKey(const SendOptions& options) {
+        return options.conflate ? options.key : std::nullopt;
+    }
+
+    static void DeliverMessage(IWebSocketMessengerCallback& callback, std::string_view message,
+                               MessageType type) {
+        if (type == MessageType::Binary) {
+            callback.OnBinaryMessageReceived(std::span<const std::byte>(
+                reinterpret_cast<const std::byte*>(message.data()), message.size()));
+        } else {
+            callback.OnMessageReceived(message);
+        }
+    }
+
+    // Receive dispatch. The IO context is the ring's only producer and the single drain task
+    // scheduled on the dispatch executor its only consumer.
+    void Dispatch(DispatchedMessage&& message) {
+        // Reading is paused while a message is held, so nothing can overtake it
+        assert(!held_message_);
+
+        // Messages are dropped whole: once the first fragment of a message is dropped, so are the
+        // rest of its fragments, and once it is queued, so are they
+        const bool continues_message = in_fragmented_message_;
+        if (message.is_fragment) {
+            in_fragmented_message_ = !message.is_final;
+        }
+        if (continues_message && dropping_fragments_) {
+            ReleaseReceivedBytes(message.payload.size());
+            return;
+        }
+        dropping_fragments_ = false;
+
+        if (dispatch_queue_->TryPush(std::move(message))) {
+            stats_.Add(StatCounter::ReceiveQueueSize);
+            ScheduleDispatch();
+            return;
+        }
+
+        if (connection_config_.receive_dispatch.overflow_policy ==
+                ReceiveOverflowPolicy::DropNewest &&
+            !continues_message) {
+            stats_.Add(StatCounter::ReceivedMessagesDropped);
+            ReleaseReceivedBytes(message.payload.size());
+            dropping_fragments_ = in_fragmented_message_;
+            return;
+        }
+
+        // Keep the message until the queue has drained and stop reading meanwhile. The drain task
+        // may have emptied the queue already, so make sure one runs to see the paused flag.
+        held_message_ = std::move(message);
+        stats_.Add(StatCounter::ReceivePauses);
+        SetReceivePaused(PausedByDispatchQueue, true);
+        dispatch_paused_.store(true);
+        ScheduleDispatch();
+    }
+
+    void ScheduleDispatch() {
+        if (dispatch_scheduled_.exchange(true)) {
+            return;
+        }
+
+        work_tracker_->Add();
+        connection_config_.receive_dispatch.executor([this, tracker = work_tracker_]() {
+            DrainDispatchQueue(*tracker);
+            tracker->Remove();
+        });
+    }
+
+    // Runs alongside the IO context, and a callback may destroy the messenger, so the messenger is
+    // only touched while entered into the tracker and never during a callback
+    void DrainDispatchQueue(WorkTracker& tracker) {
+        if (!tracker.TryEnter()) {
+            return;
+        }
+        dispatch_thread_.store(std::this_thread::get_id());
+
+        IWebSocketMessengerCallback& callback = messenger_callback_;
+        DispatchedMessage message;
+        for (;;) {
+            while (!stop_requested_ && dispatch_queue_->TryPop(message)) {
+                stats_.Subtract(StatCounter::ReceiveQueueSize);
+                RequestDispatchResume();
+                const bool release = !explicit_receive_release_;
+
+                tracker.Leave();
+                if (message.is_fragment) {
+                    callback.OnMessageFragment(message.payload, message.type, message.is_final);
+                } else {
+                    DeliverMessage(callback, message.payload, message.type);
+                }
+                if (!tracker.TryEnter()) {
+                    return;
+                }
+
+                if (release) {
+                    ReleaseReceivedBytes(message.payload.size());
+                }
+            }
+
+            // A message pushed after the flag is cleared schedules a new task, unless this one
+            // takes the flag back to drain it
+            dispatch_scheduled_.store(false);
+            if (stop_requested_ || dispatch_queue_->Empty() || dispatch_scheduled_.exchange(true)) {
+                break;
+            }
+        }
+
+        RequestDispatchResume();
+
+        dispatch_thread_.store(std::thread::id());
+        tracker.Leave();
+    }
+
+    // Resumes reading once the queue is at most half full, so a paused connection is not resumed
+    // and paused again for every message
+    void RequestDispatchResume() {
+        if (!dispatch_paused_.load(std::memory_order_relaxed) ||
+            dispatch_queue_->Size() > dispatch_queue_->Capacity() / 2) {
+            return;
+        }
+        if (dispatch_paused_.exchange(false)) {
+            Post([this]() { ResumeDispatch(); });
+        }
+    }
+
+    void ResumeDispatch() {
+        if (stop_requested_) {
+            held_message_.reset();
+            return;
+        }
+
+        if (held_message_) {
+            // Only the IO context pushes and the queue has drained, so the held message fits
+            const bool pushed = dispatch_queue_->TryPush(std::move(*held_message_));
+            assert(pushed);
+            (void)pushed;
+            held_message_.reset();
+            stats_.Add(StatCounter::ReceiveQueueSize);
+            ScheduleDispatch();
+        }
+
+        SetReceivePaused(PausedByDispatchQueue, false);
+    }
+
+    // Read-side flow control, on the IO context. The client only reads while no reason to pause
+    // is set.
+    void SetReceivePaused(ReceivePauseReason reason, bool paused) {
+        const bool was_paused = receive_pause_reasons_ != 0;
+        if (paused) {
+            receive_pause_reasons_ |= reason;
+        } else {
+            receive_pause_reasons_ &= ~reason;
+        }
+
+        const bool is_paused = receive_pause_reasons_ != 0;
+        if (!client_ || was_paused == is_paused) {
+            return;
+        }
+        if (is_paused) {
+            client_->PauseReading();
+        } else {
+            client_->ResumeReading();
+        }
+    }
+
+    // Only messages handed to another thread can pile up; inline callbacks process them at once
+    bool TracksUnprocessedReceiveBytes() const {
+        return connection_config_.receive_flow_control.high_watermark_bytes != 0 &&
+               (dispatch_queue_ || explicit_receive_release_);
+    }
+
+    void AddUnprocessedReceiveBytes(size_t bytes) {
+        if (!TracksUnprocessedReceiveBytes()) {
+            return;
+        }
+
+        const size_t unprocessed = unprocessed_receive_bytes_.fetch_add(bytes) + bytes;
+        if (unprocessed < connection_config_.receive_flow_control.high_watermark_bytes ||
+            watermark_paused_.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        stats_.Add(StatCounter::ReceivePauses);
+        SetReceivePaused(PausedByWatermark, true);
+        // Everything may have been released before the flag was set, with nobody left to resume
+        watermark_paused_.store(true);
+        CheckWatermarkResume();
+    }
+
+    void CheckWatermarkResume() {
+        const size_t low_watermark = connection_config_.receive_flow_control.low_watermark_bytes;
+        if (watermark_paused_.load() && unprocessed_receive_bytes_.load() <= low_watermark) {
+            watermark_paused_.store(false);
+            SetReceivePaused(PausedByWatermark, false);
+        }
+    }
+
   private:
+    // Declared first so the IO threads outlive everything that may still be referenced by them
+    std::shared_ptr<BeastRuntime> runtime_;
+    net::strand<net::io_context::executor_type> strand_;
+    BlockPool& handler_memory_;
+    // Shared with every handler, timer and client of the messenger, which may outlive it when it is
+    // destroyed where it cannot wait for them
+    std::shared_ptr<WorkTracker> work_tracker_{ std::make_shared<WorkTracker>() };
+
     std::atomic<bool> stop_requested_{ false };
     std::atomic<bool> pending_critical_failure_handling_{ false };
+    std::atomic<bool> is_open_{ false };
 
-    std::unique_ptr<boost::asio::executor_work_guard<net::io_context::executor_type>> work_guard_;
     std::unique_ptr<boost::asio::steady_timer> reconnect_timer_;
-    net::io_context ioc_;
-    ssl::context ctx_;
-    std::thread context_thread_;
+    std::shared_ptr<TlsContext> tls_context_;
 
-    ConnectionStatsInternal stats_;
+    ShardedCounters<StatCounter> stats_;
+    LatencyStatsInternal latency_stats_;
+    bool track_queued_messages_ = false;
 
     IWebSocketMessengerCallback& messenger_callback_;
     ConnectionConfig connection_config_;
+    BufferPool send_buffers_;  // Outlives the send policy, which recycles payloads into it
     std::shared_ptr<ISendPolicy> send_policy_;
     std::shared_ptr<ClientFactoryT> client_factory_;
+    // Clients call the messenger through it, and keep it alive through their lifetime guard
+    std::shared_ptr<ClientCallbackRelay> client_callbacks_;
     std::shared_ptr<WebSocketClientT> client_;
 
+    // Only set with `receive_dispatch`; `held_message_` is only used on the IO context
+    std::unique_ptr<SpscRingBuffer<DispatchedMessage>> dispatch_queue_;
+    std::optional<DispatchedMessage> held_message_;
+    // Whether the last fragment dispatched was not final, and whether its message is being dropped
+    bool in_fragmented_message_{ false };
+    bool dropping_fragments_{ false };
+    std::atomic<bool> dispatch_scheduled_{ false };
+    std::atomic<bool> dispatch_paused_{ false };
+    std::atomic<std::thread::id> dispatch_thread_;
+
+    // `receive_pause_reasons_` is only used on the IO context, and `watermark_paused_` only set
+    // there
+    uint8_t receive_pause_reasons_{ 0 };
+    bool explicit_receive_release_{ false };
+    std::atomic<size_t> unprocessed_receive_bytes_{ 0 };
+    std::atomic<bool> watermark_paused_{ false };
+    std::atomic<bool> watermark_check_posted_{ false };
+
     int reconnect_attempts_;
     std::chrono::steady_clock::time_point last_reconnect_attempt_;
     static constexpr std::chrono::seconds ReconnectDelay{ 5 };
+
+    // Last, on a line of its own, as every send and every write touch it
+    alignas(64) std::atomic<size_t> queued_messages_{ 0 };
 };
 }  // namespace WS
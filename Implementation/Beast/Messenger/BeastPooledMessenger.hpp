@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Implementation/Beast/Common.hpp"
+#include "Implementation/Beast/Messenger/BeastMessenger.hpp"
+#include "Implementation/Beast/Runtime/BeastRuntime.hpp"
+#include "Include/WebSocketMessenger.hpp"
+
+namespace WS {
+// A fixed set of BeastMessengers connected to the same server, presented as one messenger. Every
+// member keeps its own send policy, strand and reconnect logic; the pool only picks the member
+// each message goes to and folds the members' connection events into one stream of events.
+template <SendBehaviorInternal SendBehaviorT, typename ClientFactoryT>
+class BeastPooledMessenger : public IWebSocketMessenger {
+  private:
+    using MessengerT = BeastMessenger<SendBehaviorT, ClientFactoryT>;
+
+    // Forwards a member's callbacks to the user's, tracking whether the member is connected
+    class MemberCallback : public IWebSocketMessengerCallback {
+      public:
+        explicit MemberCallback(BeastPooledMessenger& pool) : pool_(pool) {}
+
+        void OnMessageReceived(std::string_view message) override {
+            pool_.callback_.OnMessageReceived(message);
+        }
+
+        void OnBinaryMessageReceived(std::span<const std::byte> message) override {
+            pool_.callback_.OnBinaryMessageReceived(message);
+        }
+
+        void OnMessageFragment(std::string_view fragment, MessageType type,
+                               bool is_final) override {
+            pool_.callback_.OnMessageFragment(fragment, type, is_final);
+        }
+
+        void OnMessageExpired(std::string_view message, MessageType type) override {
+            pool_.callback_.OnMessageExpired(message, type);
+        }
+
+        void OnConnected() override {
+            connected_ = true;
+            if (pool_.connected_members_.fetch_add(1) == 0) {
+                pool_.callback_.OnConnected();
+            }
+        }
+
+        void OnDisconnected(const ErrorDetails& error) override {
+            // Failed connection attempts are only reported while no other member is connected
+            if (connected_.exchange(false)) {
+                if (pool_.connected_members_.fetch_sub(1) == 1) {
+                    pool_.callback_.OnDisconnected(error);
+                }
+            } else if (pool_.connected_members_ == 0) {
+                pool_.callback_.OnDisconnected(error);
+            }
+        }
+
+        void SignalCriticalFailure() override { pool_.callback_.SignalCriticalFailure(); }
+
+        bool IsConnected() const { return connected_.load(std::memory_order_relaxed); }
+
+      private:
+        BeastPooledMessenger& pool_;
+        std::atomic<bool> connected_{ false };
+    };
+
+    struct Member {
+        std::unique_ptr<MemberCallback> callback;
+        std::unique_ptr<MessengerT> messenger;
+    };
+
+  public:
+    BeastPooledMessenger(IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+                         const PoolSettings& settings,
+                         std::shared_ptr<BeastRuntime> runtime = nullptr)
+        : callback_(callback), balancing_(settings.balancing) {
+        if (settings.connection_count == 0) {
+            throw std::invalid_argument("Pooled messenger needs at least one connection");
+        }
+
+        // Without a shared runtime every member gets an IO thread of its own, which is what lets
+        // the pool encrypt on several cores at once
+        if (!runtime) {
+            runtime = std::make_shared<BeastRuntime>(settings.connection_count);
+        }
+
+        members_.reserve(settings.connection_count);
+        for (size_t i = 0; i < settings.connection_count; ++i) {
+            Member member;
+            member.callback = std::make_unique<MemberCallback>(*this);
+            member.messenger = std::make_unique<MessengerT>(*member.callback, config, nullptr,
+                                                            nullptr, runtime);
+            if (balancing_ == PoolBalancing::LeastQueued) {
+                member.messenger->TrackQueuedMessages();
+            }
+            members_.push_back(std::move(member));
+        }
+    }
+
+    ~BeastPooledMessenger() { Close(); }
+
+    // IWebSocketMessenger
+    bool Open() override {
+        for (Member& member : members_) {
+            if (!member.messenger->Open()) {
+                Close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Buffers go back to whichever member wrote them, and sends are spread over all members, so
+    // taking them round-robin keeps the members' pools in use evenly
+    std::string AcquireSendBuffer(size_t capacity) override {
+        const size_t member = next_buffer_member_.fetch_add(1, std::memory_order_relaxed);
+        return members_[member % members_.size()].messenger->AcquireSendBuffer(capacity);
+    }
+
+    bool Send(std::string&& message, const SendOptions& options) override {
+        return SelectMember(options).Send(std::move(message), options);
+    }
+
+    bool Send(std::span<const std::byte> message, const SendOptions& options) override {
+        return SelectMember(options).Send(message, options);
+    }
+
+    bool Send(SharedPayload message, const SendOptions& options) override {
+        return SelectMember(options).Send(std::move(message), options);
+    }
+
+    SendResult TrySend(std::string&& message, const SendOptions& options) override {
+        return SelectMember(options).TrySend(std::move(message), options);
+    }
+
+    SendResult TrySend(SharedPayload message, const SendOptions& options) override {
+        return SelectMember(options).TrySend(std::move(message), options);
+    }
+
+    SendResult SendStream(std::shared_ptr<IMessageStreamProducer> producer,
+                          const SendOptions& options) override {
+        return SelectMember(options).SendStream(std::move(producer), options);
+    }
+
+    void PauseReceive() override {
+        for (Member& member : members_) {
+            member.messenger->PauseReceive();
+        }
+    }
+
+    void ResumeReceive() override {
+        for (Member& member : members_) {
+            member.messenger->ResumeReceive();
+        }
+    }
+
+    void Close() override {
+        for (Member& member : members_) {
+            member.messenger->Close();
+        }
+    }
+
+    ConnectionStats GetConnectionStats() const override {
+        ConnectionStats total;
+        for (const Member& member : members_) {
+            const ConnectionStats stats = member.messenger->GetConnectionStats();
+            total.total_messages_sent += stats.total_messages_sent;
+            total.total_messages_received += stats.total_messages_received;
+            total.total_bytes_sent += stats.total_bytes_sent;
+            total.total_bytes_received += stats.total_bytes_received;
+            total.current_send_queue_size += stats.current_send_queue_size;
+            total.total_messages_dropped += stats.total_messages_dropped;
+            for (size_t i = 0; i < SendPriorityCount; ++i) {
+                total.current_send_queue_size_by_priority[i] +=
+                    stats.current_send_queue_size_by_priority[i];
+                total.total_messages_dropped_by_priority[i] +=
+                    stats.total_messages_dropped_by_priority[i];
+            }
+            total.total_messages_rejected += stats.total_messages_rejected;
+            total.total_messages_conflated += stats.total_messages_conflated;
+            total.total_messages_expired += stats.total_messages_expired;
+            total.total_tls_handshakes += stats.total_tls_handshakes;
+            total.total_tls_sessions_resumed += stats.total_tls_sessions_resumed;
+            total.total_wire_bytes_sent += stats.total_wire_bytes_sent;
+            total.total_wire_bytes_received += stats.total_wire_bytes_received;
+            total.current_receive_queue_size += stats.current_receive_queue_size;
+            total.total_received_messages_dropped += stats.total_received_messages_dropped;
+            total.total_receive_pauses += stats.total_receive_pauses;
+            total.current_unprocessed_receive_bytes += stats.current_unprocessed_receive_bytes;
+        }
+        MessengerT::SetCompressionRatios(total);
+        return total;
+    }
+
+    LatencyStats GetLatencyStats() const override {
+        auto histograms = std::make_unique<typename MessengerT::LatencyStatsInternal>();
+        for (const Member& member : members_) {
+            histograms->Merge(member.messenger->GetLatencyHistograms());
+        }
+        return histograms->GetPercentiles();
+    }
+
+    bool ScheduleReconnect(std::optional<ServerSettings> settings) override {
+        // Only the members that signalled a critical failure accept the reconnect
+        bool scheduled = false;
+        for (Member& member : members_) {
+            scheduled |= member.messenger->ScheduleReconnect(settings);
+        }
+        return scheduled;
+    }
+
+  private:
+    MessengerT& SelectMember(const SendOptions& options) {
+        const size_t count = members_.size();
+
+        if (balancing_ == PoolBalancing::KeyHash && options.key) {
+            // Fibonacci hashing spreads sequential keys evenly
+            const uint64_t hash = *options.key * 0x9E3779B97F4A7C15ull;
+            return *members_[(hash >> 32) % count].messenger;
+        }
+
+        if (balancing_ == PoolBalancing::LeastQueued && count > 1) {
+            // The less queued of two distinct random members balances nearly as well as the least
+            // queued of all, and reads two gauges instead of every member's
+            const uint64_t random = NextRandom();
+            const size_t first = (random >> 32) % count;
+            const size_t second = (first + 1 + (random & 0xFFFFFFFF) % (count - 1)) % count;
+            Member& a = members_[first];
+            Member& b = members_[second];
+            const bool a_connected = a.callback->IsConnected();
+            const bool b_connected = b.callback->IsConnected();
+            if (a_connected && b_connected) {
+                return a.messenger->GetQueuedMessages() <= b.messenger->GetQueuedMessages()
+                           ? *a.messenger
+                           : *b.messenger;
+            }
+            if (a_connected || b_connected) {
+                return a_connected ? *a.messenger : *b.messenger;
+            }
+        }
+
+        // Round-robin over the connected members: every turn goes to the n-th connected member, so
+        // a disconnected member's share is spread over all the others rather than its neighbour.
+        // While none is connected the message is queued on the next member in turn, like with a
+        // single reconnecting messenger.
+        const size_t turn = next_member_.fetch_add(1, std::memory_order_relaxed);
+        const size_t connected = connected_members_.load(std::memory_order_relaxed);
+        if (connected > 0) {
+            size_t skip = turn % connected;
+            for (Member& member : members_) {
+                if (member.callback->IsConnected() && skip-- == 0) {
+                    return *member.messenger;
+                }
+            }
+        }
+        // Also reached when a member disconnected while counting
+        return *members_[turn % count].messenger;
+    }
+
+    // A per-thread xorshift generator; the samples need to be cheap, not good
+    static uint64_t NextRandom() {
+        // Constant-initialized, so reading it needs no thread_local guard check
+        thread_local uint64_t state = 0;
+        if (state == 0) {
+            state = std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+  private:
+    IWebSocketMessengerCallback& callback_;
+    const PoolBalancing balancing_;
+    std::atomic<size_t> connected_members_{ 0 };
+    std::atomic<size_t> next_member_{ 0 };
+    std::atomic<size_t> next_buffer_member_{ 0 };
+
+    std::vector<Member> members_;
+};
+}  // namespace WS
@@ -0,0 +1,60 @@
+#include "Implementation/Beast/Runtime/BeastRuntime.hpp"
+
+#include <stdexcept>
+
+namespace WS {
+BeastRuntime::BeastRuntime(size_t thread_count, std::shared_ptr<TlsContext> tls_context)
+    : tls_context_(std::move(tls_context)) {
+    const size_t worker_count = thread_count > 0 ? thread_count : 1;
+
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->work_guard =
+            std::make_unique<boost::asio::executor_work_guard<net::io_context::executor_type>>(
+                net::make_work_guard(worker->ioc));
+        worker->thread = std::thread([worker = worker.get()]() {
+            worker->ioc.run();
+            if (worker->owns_itself) {
+                delete worker;
+            }
+        });
+        workers_.push_back(std::move(worker));
+    }
+}
+
+BeastRuntime::~BeastRuntime() {
+    for (auto& worker : workers_) {
+        worker->work_guard.reset();  // let run() return once outstanding work is done
+    }
+
+    for (auto& worker : workers_) {
+        if (std::this_thread::get_id() != worker->thread.get_id()) {
+            worker->thread.join();
+            continue;
+        }
+
+        // Destroyed from a handler, e.g. by the last messenger using the runtime. The thread
+        // cannot join itself, so it lets go of the worker once its handler has returned.
+        worker->thread.detach();
+        worker->owns_itself = true;
+        worker.release();
+    }
+}
+
+size_t BeastRuntime::GetThreadCount() const { return workers_.size(); }
+
+net::io_context& BeastRuntime::AcquireContext() {
+    const size_t index = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    return workers_[index]->ioc;
+}
+
+BlockPool& BeastRuntime::GetHandlerMemory(const net::io_context& context) {
+    for (auto& worker : workers_) {
+        if (&worker->ioc == &context) {
+            return worker->handler_memory;
+        }
+    }
+    throw std::invalid_argument("io_context does not belong to this runtime");
+}
+}  // namespace WS
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Implementation/Beast/Common.hpp"
+#include "Implementation/Beast/Tls/TlsContext.hpp"
+#include "Implementation/Internal/BlockPool.hpp"
+#include "Include/WebSocketMessenger.hpp"
+
+namespace WS {
+// Pool of IO threads, each running its own io_context. Messengers pick a context round-robin and
+// run on their own strand over it, so many connections share a small, fixed number of threads.
+class BeastRuntime : public IMessengerRuntime {
+  private:
+    // Handlers posted from other threads are small; larger ones are not worth keeping
+    static constexpr size_t HandlerBlockSize = 256;
+    static constexpr size_t MaxFreeHandlerBlocks = 1024;
+
+    struct Worker {
+        // Declared first so it outlives the handlers the io_context destroys
+        BlockPool handler_memory{ HandlerBlockSize, MaxFreeHandlerBlocks };
+        net::io_context ioc;
+        std::unique_ptr<boost::asio::executor_work_guard<net::io_context::executor_type>>
+            work_guard;
+        std::thread thread;
+        // Set when the runtime is destroyed on the worker's own thread, which then deletes it
+        bool owns_itself{ false };
+    };
+
+  public:
+    // Messengers on the runtime use `tls_context` if given, and the process-wide default otherwise
+    explicit BeastRuntime(size_t thread_count, std::shared_ptr<TlsContext> tls_context = nullptr);
+    ~BeastRuntime();
+
+    BeastRuntime(const BeastRuntime&) = delete;
+    BeastRuntime& operator=(const BeastRuntime&) = delete;
+
+    // IMessengerRuntime
+    size_t GetThreadCount() const override;
+
+    // Returns the io_context a new messenger should run on. Contexts are handed out round-robin.
+    net::io_context& AcquireContext();
+
+    // Memory for handlers posted to `context` from other threads, which must be one handed out by
+    // AcquireContext. It lives as long as the context.
+    BlockPool& GetHandlerMemory(const net::io_context& context);
+
+    const std::shared_ptr<TlsContext>& GetTlsContext() const { return tls_context_; }
+
+  private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{ 0 };
+    std::shared_ptr<TlsContext> tls_context_;
+};
+}  // namespace WS
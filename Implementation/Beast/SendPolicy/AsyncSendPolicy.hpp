@@ -1,37 +1,151 @@
 #pragma once
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "BeastSendPolicy.hpp"
+#include "Implementation/Internal/BlockPool.hpp"
+#include "Implementation/Internal/MpscRingBuffer.hpp"
 
 namespace WS {
-// Asynchronous send policy preserves original queuing behavior.
+// Asynchronous send policy preserves original queuing behavior within each SendPriority.
+//
+// Producer threads push into a lock-free ingress ring instead of posting one handler per message.
+// The IO context is woken at most once per batch of pushes to drain the ring into the queue of
+// each message's priority, and every write takes the queue picked by SendLaneSettings. Messages
+// sent with SendOptions::conflate replace the queued message with their key as they are drained.
+//
+// The queues and conflation indexes take their memory from a pool owned by the policy, and the
+// payloads of messages that are done with are handed back for AcquireSendBuffer, so once warmed
+// up, queueing and writing a message does not allocate.
 class AsyncSendPolicy : public ISendPolicy {
+  private:
+    // Cells of the ingress ring, allocated up front. It only has to absorb the messages sent
+    // between two drains; a burst beyond it spills into the locked overflow list.
+    static constexpr size_t IngressCapacity = 128;
+
+    // Covers the blocks of the queues and the nodes of the conflation indexes
+    static constexpr size_t QueueBlockSize = 512;
+    // Messages whose blocks the pool keeps for a queue without a limit
+    static constexpr size_t UnboundedQueueBlockMessages = 4096;
+
+    using ConflationIndex =
+        std::unordered_map<uint64_t, OutgoingMessage*, std::hash<uint64_t>,
+                           std::equal_to<uint64_t>,
+                           BlockPoolAllocator<std::pair<const uint64_t, OutgoingMessage*>>>;
+
+  protected:
+    using MessageQueue = std::deque<OutgoingMessage, BlockPoolAllocator<OutgoingMessage>>;
+
+  private:
+    struct Lane {
+        explicit Lane(BlockPool& memory)
+            : queue(BlockPoolAllocator<OutgoingMessage>(memory)),
+              conflation_index(0, std::hash<uint64_t>(), std::equal_to<uint64_t>(),
+                               ConflationIndex::allocator_type(memory)) {}
+
+        size_t max_size{ 0 };  // 0 is unbounded
+        size_t weight{ 0 };
+        // Only touched on the IO context. Elements are never moved once queued, so views into
+        // them stay valid until popped.
+        MessageQueue queue;
+        // Writes taken in a row while a lower priority was waiting; only used on the IO context
+        size_t consecutive_writes{ 0 };
+        // Queued messages with a conflation key whose write has not started, by key; only used on
+        // the IO context
+        ConflationIndex conflation_index;
+
+        // Messages accepted but not yet written, including those still in the ingress ring
+        std::atomic<size_t> queued{ 0 };
+        std::atomic<size_t> pending_evictions{ 0 };
+    };
+
   public:
-    explicit AsyncSendPolicy(ISendPolicyContext& context) : context_(context) {}
+    explicit AsyncSendPolicy(ISendPolicyContext& context)
+        : context_(context),
+          ttl_(context.GetSendTtl()),
+          queue_memory_(QueueBlockSize, MaxFreeQueueBlocks(context)),
+          lanes_(MakeLanes(queue_memory_, std::make_index_sequence<SendPriorityCount>())),
+          ingress_(IngressCapacity) {
+        const SendLaneSettings& settings = context.GetSendLaneSettings();
+        for (size_t i = 0; i < SendPriorityCount; ++i) {
+            lanes_[i].max_size = LaneLimit(context, i);
+            lanes_[i].weight = settings.weight[i];
+        }
+    }
+
+    ~AsyncSendPolicy() override {
+        // Whoever waits for a message still queued must not wait forever
+        DrainRing();
+        for (Lane& lane : lanes_) {
+            for (OutgoingMessage& message : lane.queue) {
+                NotifyWritten(message, MessageWriteStatus::Failure);
+            }
+        }
+        for (OutgoingMessage& message : overflow_) {
+            NotifyWritten(message, MessageWriteStatus::Failure);
+        }
+    }
 
     // Send will always queue the message even if Open() has not yet been called on the Messenger
-    bool Send(std::string&& message) override {
-        // Queue work onto IO context to preserve thread safety
-        context_.PostToIOContext(
-            [this, msg = std::move(message)]() mutable { SendMessageInternal(std::move(msg)); });
+    SendResult Send(OutgoingMessage&& message) override {
+        Lane& lane = LaneOf(message);
+        if (IsConflating(message)) {
+            // Whether it replaces a queued message is only known once it is drained, and dropping
+            // it here would keep a stale value queued instead; the queue holds one per key anyway
+            lane.queued.fetch_add(1);
+        } else if (!ReserveQueueSlot(lane)) {
+            const SendResult result = HandleQueueFull(lane, message.priority);
+            if (result != SendResult::Accepted) {
+                return result;
+            }
+        }
+
+        message.enqueue_time = std::chrono::steady_clock::now();
+        if (ttl_ && !message.deadline) {
+            message.deadline = message.enqueue_time + *ttl_;
+        }
+        context_.IncrementCurrentQueueSize(message.priority);
+        PushToIngress(std::move(message));
+        ScheduleDrain();
 
-        return true;  // Accepted for sending (may be dropped later if queue full)
+        return SendResult::Accepted;
     }
 
     void OnMessageWriteCompleted(MessageWriteStatus status) override {
         // Connection closed or failed; leave queue intact for potential reconnect
         if (status != MessageWriteStatus::Success) {
+            // The messages stay queued, so newer ones with their keys may replace them again
+            MessageQueue& queue = WriteQueue();
+            for (size_t i = 0; i < std::min(QueuedWriteCount(), queue.size()); ++i) {
+                if (queue[i].conflation_key) {
+                    write_lane_->conflation_index.try_emplace(*queue[i].conflation_key, &queue[i]);
+                }
+            }
+
+            // A streamed message cannot be replayed once its producer has been read from
+            if (!queue.empty() && queue.front().stream) {
+                NotifyWritten(queue.front(), MessageWriteStatus::Failure);
+                context_.RecordMessageDropped(queue.front().priority);
+                PopWriteQueueFront();
+            }
             write_in_progress_ = false;
             return;
         }
 
-        assert(!message_queue_.empty());
+        assert(!WriteQueue().empty());
 
-        context_.RecordMessageSent(message_queue_.front().size());
-        message_queue_.pop();
-        context_.DecrementCurrentQueueSize();
+        CompleteQueuedWrite();
 
         write_in_progress_ = false;
 
@@ -40,37 +154,352 @@ class AsyncSendPolicy : public ISendPolicy {
 
     void OnConnected() override { TryWriteNext(); }
 
+  protected:
+    // Issues a write for the message(s) at the front of the write queue. Returns false if the
+    // client did not accept the write.
+    virtual bool WriteQueued() { return context_.ClientSend(WriteQueue().front()); }
+
+    // True if the message's deadline has passed by the time the current write started
+    bool IsExpired(const OutgoingMessage& message) const {
+        return message.deadline && *message.deadline <= write_started_;
+    }
+
+    // Number of messages at the front of the write queue covered by the write in flight
+    virtual size_t QueuedWriteCount() const { return 1; }
+
+    // Accounts for and removes the message(s) covered by the last successful write.
+    virtual void CompleteQueuedWrite() {
+        CompleteWriteQueueFront(std::chrono::steady_clock::now());
+    }
+
+    // The queue of the priority picked for the current write
+    MessageQueue& WriteQueue() { return write_lane_->queue; }
+
+    void CompleteWriteQueueFront(std::chrono::steady_clock::time_point completed) {
+        OutgoingMessage& message = WriteQueue().front();
+        context_.RecordMessageSent(message.View().size());
+        context_.RecordMessageLatency(write_started_ - message.enqueue_time,
+                                      completed - write_started_);
+        NotifyWritten(message, MessageWriteStatus::Success);
+        PopWriteQueueFront();
+    }
+
   private:
-    void SendMessageInternal(std::string&& message) {
-        if (context_.GetMaxSendQueueSize() > 0 &&
-            message_queue_.size() >= context_.GetMaxSendQueueSize()) {
-            return;  // Silently drop message if queue is full
+    template <size_t... Priorities>
+    static std::array<Lane, SendPriorityCount> MakeLanes(BlockPool& memory,
+                                                         std::index_sequence<Priorities...>) {
+        return { ((void)Priorities, Lane(memory))... };
+    }
+
+    static size_t LaneLimit(ISendPolicyContext& context, size_t lane) {
+        const size_t limit = context.GetSendLaneSettings().max_queue_size[lane];
+        return limit != 0 ? limit : context.GetMaxSendQueueSize();
+    }
+
+    // Queues swing between empty and full under load, so the pool keeps the blocks of as many
+    // messages as the queues hold rather than allocating them again on every swing
+    static size_t MaxFreeQueueBlocks(ISendPolicyContext& context) {
+        size_t capacity = 0;
+        for (size_t i = 0; i < SendPriorityCount; ++i) {
+            const size_t limit = LaneLimit(context, i);
+            capacity += limit != 0 ? limit : UnboundedQueueBlockMessages;
+        }
+        return capacity * sizeof(OutgoingMessage) / QueueBlockSize + SendPriorityCount;
+    }
+
+    Lane& LaneOf(const OutgoingMessage& message) {
+        return lanes_[static_cast<size_t>(message.priority)];
+    }
+
+    void PopWriteQueueFront() {
+        const SendPriority priority = WriteQueue().front().priority;
+        context_.RecyclePayload(std::move(WriteQueue().front().payload));
+        WriteQueue().pop_front();
+        ReleaseQueueSlot(*write_lane_, priority);
+    }
+
+    // Discards the expired messages at the front of every queue. Only called while no write is in
+    // flight; expired messages further back are discarded once they reach the front.
+    void DiscardExpired() {
+        for (Lane& lane : lanes_) {
+            while (!lane.queue.empty() && IsExpired(lane.queue.front())) {
+                OutgoingMessage& expired = lane.queue.front();
+                const SendPriority priority = expired.priority;
+                RemoveFromConflationIndex(lane, expired);
+                context_.RecordMessageExpired(expired);
+                NotifyWritten(expired, MessageWriteStatus::Timeout);
+                context_.RecyclePayload(std::move(expired.payload));
+                lane.queue.pop_front();
+                ReleaseQueueSlot(lane, priority);
+            }
+        }
+    }
+
+    // Queues a drained message, or replaces the queued message with its conflation key
+    void Enqueue(OutgoingMessage&& message) {
+        Lane& lane = LaneOf(message);
+        if (!IsConflating(message)) {
+            lane.queue.push_back(std::move(message));
+            return;
+        }
+
+        auto [entry, inserted] = lane.conflation_index.try_emplace(*message.conflation_key);
+        if (inserted) {
+            lane.queue.push_back(std::move(message));
+            entry->second = &lane.queue.back();
+            return;
+        }
+
+        // The newer message takes the queued one's place, and its slot is given back
+        OutgoingMessage& queued = *entry->second;
+        NotifyWritten(queued, MessageWriteStatus::Failure);
+        context_.RecordMessageConflated();
+        context_.RecyclePayload(std::move(queued.payload));
+        queued = std::move(message);
+        ReleaseQueueSlot(lane, queued.priority);
+    }
+
+    static bool IsConflating(const OutgoingMessage& message) {
+        return message.conflation_key && !message.stream;
+    }
+
+    void RemoveFromConflationIndex(Lane& lane, const OutgoingMessage& message) {
+        if (!message.conflation_key) {
+            return;
+        }
+        const auto entry = lane.conflation_index.find(*message.conflation_key);
+        if (entry != lane.conflation_index.end() && entry->second == &message) {
+            lane.conflation_index.erase(entry);
+        }
+    }
+
+    // Counts the message against its queue limit on the producer thread, so the drop decision is
+    // made before the message is ever handed to the IO context.
+    bool ReserveQueueSlot(Lane& lane) {
+        if (lane.max_size == 0) {
+            lane.queued.fetch_add(1);
+            return true;
+        }
+
+        size_t queued = lane.queued.load();
+        do {
+            if (queued >= lane.max_size) {
+                return false;
+            }
+        } while (!lane.queued.compare_exchange_weak(queued, queued + 1));
+        return true;
+    }
+
+    void ReleaseQueueSlot(Lane& lane, SendPriority priority) {
+        lane.queued.fetch_sub(1);
+        context_.DecrementCurrentQueueSize(priority);
+
+        // Blocked producers may be waiting for any of the queues
+        if (blocked_producers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(queue_space_mutex_);
+            queue_space_cv_.notify_all();
+        }
+    }
+
+    // Applies the overflow policy once the queue is full. Returns Accepted if the message may
+    // still be queued.
+    SendResult HandleQueueFull(Lane& lane, SendPriority priority) {
+        switch (context_.GetOverflowPolicy()) {
+            case OverflowPolicy::DropOldest:
+                // The oldest message can only be removed on the IO context; take a slot beyond the
+                // limit now and leave the eviction to the next write attempt
+                lane.queued.fetch_add(1);
+                lane.pending_evictions.fetch_add(1);
+                return SendResult::Accepted;
+            case OverflowPolicy::BlockWithTimeout:
+                // Never block the IO context thread; it is the one freeing up space
+                if (!context_.IsInContextThread() && WaitForQueueSlot(lane)) {
+                    return SendResult::Accepted;
+                }
+                context_.RecordMessageDropped(priority);
+                return SendResult::Timeout;
+            case OverflowPolicy::RejectImmediately:
+                context_.RecordMessageRejected();
+                return SendResult::Rejected;
+            case OverflowPolicy::DropNewest:
+            default:
+                context_.RecordMessageDropped(priority);
+                return SendResult::Dropped;
+        }
+    }
+
+    bool WaitForQueueSlot(Lane& lane) {
+        const auto deadline =
+            std::chrono::steady_clock::now() + context_.GetSendQueueBlockTimeout();
+
+        blocked_producers_.fetch_add(1);
+        std::unique_lock<std::mutex> lock(queue_space_mutex_);
+        const bool reserved = queue_space_cv_.wait_until(
+            lock, deadline, [this, &lane] { return ReserveQueueSlot(lane); });
+        blocked_producers_.fetch_sub(1);
+
+        return reserved;
+    }
+
+    // Drops the oldest queued messages on behalf of producers that overflowed under
+    // OverflowPolicy::DropOldest. Only called while no write is in flight, so a message that is
+    // being written is never dropped.
+    void EvictPendingOldest() {
+        for (Lane& lane : lanes_) {
+            while (lane.pending_evictions.load(std::memory_order_relaxed) > 0 &&
+                   !lane.queue.empty()) {
+                OutgoingMessage& oldest = lane.queue.front();
+                const SendPriority priority = oldest.priority;
+                RemoveFromConflationIndex(lane, oldest);
+                NotifyWritten(oldest, MessageWriteStatus::Failure);
+                context_.RecyclePayload(std::move(oldest.payload));
+                lane.queue.pop_front();
+                ReleaseQueueSlot(lane, priority);
+                context_.RecordMessageDropped(priority);
+                lane.pending_evictions.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void PushToIngress(OutgoingMessage&& message) {
+        // Excess messages go through a locked overflow list; once it is in use all producers
+        // append to it to preserve ordering.
+        if (!overflow_pending_.load(std::memory_order_acquire) &&
+            ingress_.TryPush(std::move(message))) {
+            return;
         }
 
-        message_queue_.push(std::move(message));
-        context_.IncrementCurrentQueueSize();
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_.push_back(std::move(message));
+        overflow_pending_.store(true, std::memory_order_release);
+    }
+
+    void ScheduleDrain() {
+        if (!drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+            context_.PostToIOContext([this]() { DrainIngress(); });
+        }
+    }
+
+    void DrainIngress() {
+        // Clear the flag before draining: anything pushed after this point is either picked up
+        // below or schedules another drain
+        drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+
+        if (overflow_pending_.load(std::memory_order_acquire)) {
+            // Hold the lock across both stages so no producer can append to the overflow list
+            // while older messages are still in the ring
+            std::lock_guard<std::mutex> lock(overflow_mutex_);
+            DrainRing();
+
+            for (OutgoingMessage& message : overflow_) {
+                Enqueue(std::move(message));
+            }
+            overflow_.clear();
+            overflow_pending_.store(false, std::memory_order_release);
+        } else {
+            DrainRing();
+        }
 
         TryWriteNext();
     }
 
+    void DrainRing() {
+        OutgoingMessage message;
+        while (ingress_.TryPop(message)) {
+            Enqueue(std::move(message));
+        }
+    }
+
+    // Picks the queue the next write takes from, see SendLaneSettings
+    Lane* PickWriteLane() {
+        for (size_t i = 0; i < SendPriorityCount; ++i) {
+            Lane& lane = lanes_[i];
+            if (lane.queue.empty()) {
+                lane.consecutive_writes = 0;
+                continue;
+            }
+
+            if (!IsLowerLaneWaiting(i)) {
+                lane.consecutive_writes = 0;
+                return &lane;
+            }
+            if (lane.weight != 0 && lane.consecutive_writes >= lane.weight) {
+                lane.consecutive_writes = 0;  // Let the next lower priority have this write
+                continue;
+            }
+            ++lane.consecutive_writes;
+            return &lane;
+        }
+        return nullptr;
+    }
+
+    bool IsLowerLaneWaiting(size_t lane) const {
+        for (size_t i = lane + 1; i < SendPriorityCount; ++i) {
+            if (!lanes_[i].queue.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void TryWriteNext() {
-        if (message_queue_.empty() || write_in_progress_ || !context_.HasClient() ||
-            !context_.IsClientConnected()) {
+        if (write_in_progress_) {
             return;
         }
 
-        const auto& message = message_queue_.front();
+        EvictPendingOldest();
+
+        // Also while disconnected, so an outage does not hold on to messages nobody wants anymore
+        write_started_ = std::chrono::steady_clock::now();
+        DiscardExpired();
+
+        if (!context_.HasClient() || !context_.IsClientConnected()) {
+            return;
+        }
+
+        Lane* lane = PickWriteLane();
+        if (!lane) {
+            return;
+        }
+
+        write_lane_ = lane;
         write_in_progress_ = true;
 
-        if (!context_.ClientSend(message)) {
+        if (!WriteQueued()) {
             write_in_progress_ = false;
             return;  // Send failed; will retry on next OnConnected or OnMessageWriteCompleted
         }
+
+        // Messages being written can no longer be replaced
+        if (!lane->conflation_index.empty()) {
+            for (size_t i = 0; i < QueuedWriteCount(); ++i) {
+                RemoveFromConflationIndex(*lane, lane->queue[i]);
+            }
+        }
     }
 
-  private:
+  protected:
     ISendPolicyContext& context_;
+
+  private:
+    const std::optional<std::chrono::milliseconds> ttl_;
+    BlockPool queue_memory_;  // Outlives the lanes
+    std::array<Lane, SendPriorityCount> lanes_;
+    // Lane of the write in flight, or of the last one
+    Lane* write_lane_{ &lanes_[static_cast<size_t>(SendPriority::Normal)] };
     bool write_in_progress_{ false };
-    std::queue<std::string> message_queue_;
+    std::chrono::steady_clock::time_point write_started_;
+
+    std::atomic<bool> drain_scheduled_{ false };
+    MpscRingBuffer<OutgoingMessage> ingress_;
+
+    std::atomic<bool> overflow_pending_{ false };
+    std::mutex overflow_mutex_;
+    MessageQueue overflow_{ BlockPoolAllocator<OutgoingMessage>(queue_memory_) };
+
+    // Producers blocked under OverflowPolicy::BlockWithTimeout
+    std::atomic<size_t> blocked_producers_{ 0 };
+    std::mutex queue_space_mutex_;
+    std::condition_variable queue_space_cv_;
 };
 }  // namespace WS
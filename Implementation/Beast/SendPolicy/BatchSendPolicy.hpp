@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+#include "AsyncSendPolicy.hpp"
+
+namespace WS {
+// Batched send policy: queues like AsyncSendPolicy, but drains as many queued messages of the
+// picked priority as the batch limits allow into a single client write. Without a delimiter each
+// message is written as its own frame, and the frames reach TLS in one write; with a delimiter the
+// batch is joined into a single message using gather buffers, without copying the payloads.
+class BatchSendPolicy : public AsyncSendPolicy {
+  public:
+    explicit BatchSendPolicy(ISendPolicyContext& context) : AsyncSendPolicy(context) {}
+
+    // The written messages are sent; the failed completion that follows keeps the rest queued
+    void OnBatchPartiallyWritten(size_t messages_written) override {
+        assert(messages_written <= batch_.size());
+
+        const auto completed = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages_written; ++i) {
+            CompleteWriteQueueFront(completed);
+        }
+
+        batch_.erase(batch_.begin(), batch_.begin() + static_cast<ptrdiff_t>(messages_written));
+    }
+
+  protected:
+    bool WriteQueued() override {
+        const BatchSettings& settings = context_.GetBatchSettings();
+        const MessageQueue& queue = WriteQueue();
+
+        batch_.clear();
+
+        // Streamed messages are always written on their own
+        if (queue.front().stream) {
+            batch_.emplace_back();
+            return context_.ClientSend(queue.front());
+        }
+
+        size_t batch_bytes = 0;
+        const MessageType type = queue.front().type;
+        for (const OutgoingMessage& message : queue) {
+            // The first message is always written, even if it exceeds the byte limit on its own.
+            // A batch shares one opcode, so it also ends where the message type changes, and it
+            // ends before an expired message, which is discarded once it reaches the front.
+            const std::string_view payload = message.View();
+            if (!batch_.empty() &&
+                (batch_.size() >= settings.max_batch_count ||
+                 batch_bytes + payload.size() > settings.max_batch_bytes ||
+                 message.type != type || message.stream || IsExpired(message))) {
+                break;
+            }
+
+            batch_.push_back(payload);
+            batch_bytes += payload.size();
+        }
+
+        std::optional<std::string_view> delimiter;
+        if (settings.delimiter) {
+            delimiter = *settings.delimiter;
+        }
+
+        return context_.ClientSendBatch(batch_, type, delimiter);
+    }
+
+    size_t QueuedWriteCount() const override { return batch_.size(); }
+
+    void CompleteQueuedWrite() override {
+        assert(batch_.size() <= WriteQueue().size());
+
+        const auto completed = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < batch_.size(); ++i) {
+            CompleteWriteQueueFront(completed);
+        }
+
+        batch_.clear();
+    }
+
+  private:
+    // Views into the front of the write queue covered by the write in flight
+    std::vector<std::string_view> batch_;
+};
+}  // namespace WS
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include "Implementation/Internal/ClientCallbackInterfaces.hpp"
 #include "Include/WebSocketMessenger.hpp"
@@ -11,9 +16,41 @@ namespace WS {
 enum class SendBehaviorInternal {
     Sync,
     Async,
+    Batched,
+    PipelinedSync,
     Custom,
 };
 
+// A message accepted by the messenger and owned by the send policy until it has been written.
+// The payload is either owned, shared with other messengers when `shared_payload` is set, or
+// pulled from `stream` while the message is written.
+struct OutgoingMessage {
+    std::string payload;
+    MessageType type{ MessageType::Text };
+    SharedPayload shared_payload;
+    std::shared_ptr<IMessageStreamProducer> stream;
+    SendPriority priority{ SendPriority::Normal };
+    // Set for SendOptions::conflate
+    std::optional<uint64_t> conflation_key;
+    // SendOptions::deadline, or the send TTL applied by the send policy
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    // Set by the send policy when the message is accepted
+    std::chrono::steady_clock::time_point enqueue_time;
+    // If set, invoked once on the IO context with the outcome of the write, including when the
+    // message is dropped or discarded after having been accepted
+    std::function<void(MessageWriteStatus)> on_written;
+
+    std::string_view View() const {
+        return shared_payload ? std::string_view(*shared_payload) : std::string_view(payload);
+    }
+};
+
+inline void NotifyWritten(OutgoingMessage& message, MessageWriteStatus status) {
+    if (message.on_written) {
+        std::exchange(message.on_written, nullptr)(status);
+    }
+}
+
 class ISendPolicyContext {
   public:
     virtual ~ISendPolicyContext() = default;
@@ -23,19 +60,41 @@ class ISendPolicyContext {
     virtual bool IsReadyForSynchronousSend() const = 0;
     virtual bool IsInContextThread() const = 0;
     virtual size_t GetMaxSendQueueSize() const = 0;
+    virtual OverflowPolicy GetOverflowPolicy() const = 0;
+    virtual std::chrono::milliseconds GetSendQueueBlockTimeout() const = 0;
+    virtual std::optional<std::chrono::milliseconds> GetSendTtl() const = 0;
+    virtual const SendLaneSettings& GetSendLaneSettings() const = 0;
+    virtual const BatchSettings& GetBatchSettings() const = 0;
+    virtual const SyncSendSettings& GetSyncSendSettings() const = 0;
     virtual void PostToIOContext(std::function<void()> fn) = 0;
-    virtual bool ClientSend(const std::string& message) = 0;
-    virtual void IncrementCurrentQueueSize() = 0;
-    virtual void DecrementCurrentQueueSize() = 0;
+    virtual bool ClientSend(const OutgoingMessage& message) = 0;
+    // Writes all messages with a single completion. If a delimiter is given, the messages are
+    // joined into one WebSocket message, otherwise each is written as its own message. All
+    // messages are written with the same opcode.
+    virtual bool ClientSendBatch(std::span<const std::string_view> messages, MessageType type,
+                                 std::optional<std::string_view> delimiter) = 0;
+    virtual void IncrementCurrentQueueSize(SendPriority priority) = 0;
+    virtual void DecrementCurrentQueueSize(SendPriority priority) = 0;
     virtual void RecordMessageSent(size_t message_size_bytes) = 0;
+    virtual void RecordMessageLatency(std::chrono::nanoseconds queue_wait,
+                                      std::chrono::nanoseconds write_duration) = 0;
+    virtual void RecordMessageDropped(SendPriority priority) = 0;
+    virtual void RecordMessageRejected() = 0;
+    virtual void RecordMessageConflated() = 0;
+    // Called on the IO context for a message discarded because its deadline passed
+    virtual void RecordMessageExpired(const OutgoingMessage& message) = 0;
+    // Hands the payload of a message that is done with back for AcquireSendBuffer to reuse
+    virtual void RecyclePayload(std::string&& payload) = 0;
 };
 
 class ISendPolicy {
   public:
     virtual ~ISendPolicy() = default;
 
-    virtual bool Send(std::string&& message) = 0;  // Depending on policy may block.
+    virtual SendResult Send(OutgoingMessage&& message) = 0;  // Depending on policy may block.
     virtual void OnMessageWriteCompleted(MessageWriteStatus status) = 0;
+    // Only called for writes issued through ClientSendBatch
+    virtual void OnBatchPartiallyWritten(size_t /*messages_written*/) {}
     virtual void OnConnected() {}
 };
 
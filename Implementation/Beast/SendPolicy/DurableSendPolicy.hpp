@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "BeastSendPolicy.hpp"
+#include "Implementation/Internal/SegmentLog.hpp"
+
+namespace WS {
+// Durable send policy: appends every message to a SegmentLog on the caller's thread and writes
+// them from the front of the log on the IO context, one at a time. A record is acknowledged once
+// its write completes, so after a failed write or a restart the log resumes at the first message
+// not known to be written.
+//
+// Only the message in flight is held in memory; the backlog lives in the mapped segment files,
+// where the OS can write it back and evict it as needed.
+class DurableSendPolicy : public ISendPolicy {
+  public:
+    DurableSendPolicy(ISendPolicyContext& context, const DurableSendSettings& settings)
+        : context_(context) {
+        if (settings.directory.empty()) {
+            throw std::invalid_argument("Durable send directory must be set");
+        }
+
+        if (settings.segment_size == 0) {
+            throw std::invalid_argument("Durable send segment size must not be zero");
+        }
+
+        log_ = SegmentLog::Open(settings.directory, settings.segment_size,
+                                settings.max_disk_bytes);
+        if (!log_) {
+            throw std::invalid_argument("Failed to open the durable send log");
+        }
+
+        // Left over from an earlier messenger; written once connected
+        for (size_t i = 0; i < log_->Size(); ++i) {
+            context_.IncrementCurrentQueueSize(SendPriority::Normal);
+        }
+    }
+
+    SendResult Send(OutgoingMessage&& message) override {
+        if (message.stream) {
+            context_.RecordMessageRejected();  // Cannot be stored before it is written
+            return SendResult::Rejected;
+        }
+
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        {
+            std::lock_guard lock(log_mutex_);
+            if (!log_->Append(message.View(), static_cast<uint8_t>(message.type),
+                              timestamp.count())) {
+                context_.RecordMessageDropped(SendPriority::Normal);
+                return SendResult::Dropped;  // Too large, or the disk limit is reached
+            }
+        }
+
+        context_.IncrementCurrentQueueSize(SendPriority::Normal);
+        NotifyWritten(message, MessageWriteStatus::Success);  // Stored; the log owns it now
+        context_.RecyclePayload(std::move(message.payload));
+
+        if (!write_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+            context_.PostToIOContext([this]() {
+                write_scheduled_.store(false, std::memory_order_release);
+                TryWriteNext();
+            });
+        }
+        return SendResult::Accepted;
+    }
+
+    void OnMessageWriteCompleted(MessageWriteStatus status) override {
+        write_in_progress_ = false;
+        if (status != MessageWriteStatus::Success) {
+            return;  // Left at the front of the log and written again once reconnected
+        }
+
+        {
+            std::lock_guard lock(log_mutex_);
+            log_->Acknowledge();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        context_.DecrementCurrentQueueSize(SendPriority::Normal);
+        context_.RecordMessageSent(in_flight_.payload.size());
+        context_.RecordMessageLatency(queue_wait_, now - write_started_);
+
+        TryWriteNext();
+    }
+
+    void OnConnected() override { TryWriteNext(); }
+
+  private:
+    void TryWriteNext() {
+        if (write_in_progress_ || !context_.HasClient() || !context_.IsClientConnected()) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(log_mutex_);
+            const auto record = log_->Front();
+            if (!record) {
+                return;
+            }
+
+            // The buffer keeps its capacity, so this stops allocating once it has grown to the
+            // largest message
+            in_flight_.payload.assign(record->payload);
+            in_flight_.type = static_cast<MessageType>(record->type);
+
+            // Measured against the wall clock, which also covers time spent before a restart
+            const auto enqueued = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::nanoseconds(record->timestamp)));
+            queue_wait_ = std::max(std::chrono::system_clock::now() - enqueued,
+                                   std::chrono::system_clock::duration::zero());
+        }
+
+        write_in_progress_ = true;
+        write_started_ = std::chrono::steady_clock::now();
+        if (!context_.ClientSend(in_flight_)) {
+            write_in_progress_ = false;  // Retried on the next OnConnected
+        }
+    }
+
+  private:
+    ISendPolicyContext& context_;
+
+    // Appended to by callers and consumed on the IO context
+    std::mutex log_mutex_;
+    std::unique_ptr<SegmentLog> log_;
+
+    std::atomic<bool> write_scheduled_{ false };
+
+    // IO context only
+    bool write_in_progress_{ false };
+    OutgoingMessage in_flight_;
+    std::chrono::nanoseconds queue_wait_{ 0 };
+    std::chrono::steady_clock::time_point write_started_;
+};
+
+class DurableSendPolicyFactory : public ISendPolicyFactory {
+  public:
+    explicit DurableSendPolicyFactory(DurableSendSettings settings)
+        : settings_(std::move(settings)) {}
+
+    std::shared_ptr<ISendPolicy> Create(ISendPolicyContext& context) override {
+        return std::make_shared<DurableSendPolicy>(context, settings_);
+    }
+
+  private:
+    const DurableSendSettings settings_;
+};
+}  // namespace WS
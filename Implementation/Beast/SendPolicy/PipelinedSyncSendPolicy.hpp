@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "BeastSendPolicy.hpp"
+
+namespace WS {
+// Synchronous send policy that lets several callers block at once. Each caller waits for its own
+// write to complete, while the messages are written back to back on the socket in call order.
+//
+// Callers wait on completion slots that are recycled through a pool, so a send allocates nothing
+// once the pool has grown to the number of concurrent callers. Up to max_send_queue_size messages
+// are in the pipeline (unbounded if 0); further callers wait for a slot to free up.
+class PipelinedSyncSendPolicy : public ISendPolicy {
+  private:
+    struct CompletionSlot {
+        OutgoingMessage message;
+        std::condition_variable completed_cv;
+        bool completed{ false };
+        bool succeeded{ false };
+    };
+
+  public:
+    explicit PipelinedSyncSendPolicy(ISendPolicyContext& context)
+        : context_(context), max_in_flight_(context.GetMaxSendQueueSize()) {}
+
+    SendResult Send(OutgoingMessage&& message) override {
+        // Cannot perform synchronous send before Open() starts IO context
+        if (!context_.IsReadyForSynchronousSend()) {
+            return SendResult::Rejected;  // Messenger not ready
+        }
+
+        // Avoid deadlock if called from IO context thread
+        if (context_.IsInContextThread()) {
+            return SendResult::Rejected;  // Cannot perform blocking send from IO context thread
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        slot_available_cv_.wait(
+            lock, [this] { return max_in_flight_ == 0 || in_flight_ < max_in_flight_; });
+
+        CompletionSlot* slot = AcquireSlot();
+        message.enqueue_time = std::chrono::steady_clock::now();
+        slot->message = std::move(message);
+        pending_.push_back(slot);
+        in_flight_++;
+        context_.IncrementCurrentQueueSize(slot->message.priority);
+
+        // One drain handler picks up everything queued before it runs
+        if (!drain_scheduled_) {
+            drain_scheduled_ = true;
+            context_.PostToIOContext([this]() { DrainPending(); });
+        }
+
+        slot->completed_cv.wait(lock, [slot] { return slot->completed; });
+        const bool succeeded = slot->succeeded;
+        ReleaseSlot(slot);
+
+        return succeeded ? SendResult::Accepted : SendResult::Failed;
+    }
+
+    void OnMessageWriteCompleted(MessageWriteStatus status) override {
+        if (!write_in_progress_) {
+            return;  // Spurious callback (should not happen)
+        }
+        write_in_progress_ = false;
+
+        if (status != MessageWriteStatus::Success) {
+            // The connection is gone; nothing behind this message can be written either
+            FailAll();
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        CompletionSlot* slot = write_queue_.front();
+        write_queue_.pop_front();
+
+        context_.RecordMessageSent(slot->message.View().size());
+        context_.RecordMessageLatency(write_started_ - slot->message.enqueue_time,
+                                      std::chrono::steady_clock::now() - write_started_);
+        Complete(slot, true);
+
+        TryWriteNext();
+    }
+
+  private:
+    // Runs on the IO context
+    void DrainPending() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_scheduled_ = false;
+        write_queue_.insert(write_queue_.end(), pending_.begin(), pending_.end());
+        pending_.clear();
+
+        if (!write_in_progress_) {
+            TryWriteNext();
+        }
+    }
+
+    // Called with mutex_ held, on the IO context
+    void TryWriteNext() {
+        if (write_queue_.empty()) {
+            return;
+        }
+
+        if (!context_.IsClientConnected()) {
+            FailQueued();
+            return;
+        }
+
+        write_in_progress_ = true;
+        write_started_ = std::chrono::steady_clock::now();
+        if (!context_.ClientSend(write_queue_.front()->message)) {
+            write_in_progress_ = false;
+            FailQueued();
+        }
+    }
+
+    void FailAll() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FailQueued();
+    }
+
+    // Called with mutex_ held
+    void FailQueued() {
+        for (CompletionSlot* slot : write_queue_) {
+            Complete(slot, false);
+        }
+        write_queue_.clear();
+    }
+
+    // Called with mutex_ held
+    void Complete(CompletionSlot* slot, bool succeeded) {
+        context_.DecrementCurrentQueueSize(slot->message.priority);
+        in_flight_--;
+        NotifyWritten(slot->message,
+                      succeeded ? MessageWriteStatus::Success : MessageWriteStatus::Failure);
+        context_.RecyclePayload(std::move(slot->message.payload));
+        slot->message = {};
+        slot->succeeded = succeeded;
+        slot->completed = true;
+        slot->completed_cv.notify_one();
+        slot_available_cv_.notify_one();
+    }
+
+    // Called with mutex_ held
+    CompletionSlot* AcquireSlot() {
+        if (free_slots_.empty()) {
+            slots_.push_back(std::make_unique<CompletionSlot>());
+            return slots_.back().get();
+        }
+
+        CompletionSlot* slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    // Called with mutex_ held
+    void ReleaseSlot(CompletionSlot* slot) {
+        slot->completed = false;
+        slot->succeeded = false;
+        free_slots_.push_back(slot);
+    }
+
+  private:
+    ISendPolicyContext& context_;
+    const size_t max_in_flight_;
+
+    std::mutex mutex_;
+    std::condition_variable slot_available_cv_;
+    std::vector<std::unique_ptr<CompletionSlot>> slots_;
+    std::vector<CompletionSlot*> free_slots_;
+    // Messages from callers not yet seen by the IO context
+    std::vector<CompletionSlot*> pending_;
+    bool drain_scheduled_{ false };
+    size_t in_flight_{ 0 };
+
+    // Only touched on the IO context; the write queue under mutex_ as well
+    std::deque<CompletionSlot*> write_queue_;
+    bool write_in_progress_{ false };
+    std::chrono::steady_clock::time_point write_started_;
+};
+}  // namespace WS
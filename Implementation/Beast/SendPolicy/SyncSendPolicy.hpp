@@ -1,113 +1,280 @@
 #pragma once
 
-#include <condition_variable>
-#include <future>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 
 #include "BeastSendPolicy.hpp"
+#include "Implementation/Internal/WaitableState.hpp"
 
 namespace WS {
-// Synchronous send policy: blocks caller thread until completion. Single in-flight send.
+// Synchronous send policy: blocks caller thread until completion. Single in-flight send; callers
+// on different threads take turns.
+//
+// Every calling thread waits on a completion slot of its own, which it reuses for all its sends.
+// A caller hands its slot to the IO context through a lock-free stack and waits for its write to
+// complete on the slot's atomic state, spinning first if configured, so a send involves no
+// allocation and no lock handoff with the IO context.
+//
+// With a timeout, a caller gives up on its message only while its write has not started: the IO
+// context claims a slot before writing it, and skips slots whose caller has given up. Slots then
+// also wait for a connection that is down, rather than failing at once.
 class SyncSendPolicy : public ISendPolicy {
   private:
-    struct Payload {
-        std::string message;
-        std::promise<bool> write_promise;
+    enum SlotState : uint32_t {
+        Idle,       // Free to be used for a send
+        InFlight,   // Handed to the IO context; the caller waits for the write to start
+        Writing,    // Claimed by the IO context; the caller waits for the write to complete
+        Succeeded,  // Write completed; the caller collects the result and frees the slot
+        Failed,
+        Abandoned,  // The caller timed out before the write started; it is never written
+    };
+
+    struct CompletionSlot {
+        WaitableState state{ Idle };
+        // Owned by the IO context while the slot is in flight
+        OutgoingMessage message;
+        CompletionSlot* next{ nullptr };  // In the posted stack, then in the write queue
+        // Keeps the slot alive while it is in flight, even if its thread has moved on
+        std::shared_ptr<CompletionSlot> self;
     };
 
   public:
     explicit SyncSendPolicy(ISendPolicyContext& context) : context_(context) {}
 
-    bool Send(std::string&& message) override {
+    ~SyncSendPolicy() {
+        // Slots whose write will never complete, e.g. when the messenger is destroyed with their
+        // drain or write still pending. Nothing else runs on the policy anymore.
+        CompletionSlot* posted = posted_.exchange(nullptr);
+        AppendToWriteQueue(posted);
+        while (write_queue_head_) {
+            Finish(PopWriteQueue(), false);
+        }
+    }
+
+    SendResult Send(OutgoingMessage&& message) override {
         // Cannot perform synchronous send before Open() starts IO context
         if (!context_.IsReadyForSynchronousSend()) {
-            return false;  // Messenger not ready
+            return SendResult::Rejected;  // Messenger not ready
         }
 
         // Avoid deadlock if called from IO context thread
         if (context_.IsInContextThread()) {
-            return false;  // Cannot perform blocking send from IO context thread
+            return SendResult::Rejected;  // Cannot perform blocking send from IO context thread
         }
 
-        std::promise<bool> write_promise = std::promise<bool>();
-        auto future = write_promise.get_future();
-
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] { return !active_send_; });
+        const SyncSendSettings& settings = context_.GetSyncSendSettings();
+        std::optional<WaitableState::Clock::time_point> deadline;
+        if (settings.timeout) {
+            deadline = WaitableState::Clock::now() + *settings.timeout;
+        }
 
-            // Prepare for send
-            active_send_ = true;
-            send_payload_.message = std::move(message);
-            send_payload_.write_promise = std::move(write_promise);
+        std::unique_lock<std::timed_mutex> turn(turn_mutex_, std::defer_lock);
+        if (!deadline) {
+            turn.lock();
+        } else if (!turn.try_lock_until(*deadline)) {
+            return SendResult::Timeout;
+        }
 
-            context_.IncrementCurrentQueueSize();
+        const std::shared_ptr<CompletionSlot>& slot = AcquireThreadSlot();
+        message.enqueue_time = std::chrono::steady_clock::now();
+        context_.IncrementCurrentQueueSize(message.priority);
+        slot->message = std::move(message);
+        slot->self = slot;
+        slot->state.Store(InFlight);
+        Post(slot.get());
 
-            // TODO: Evaluate if shared_from_this is needed here
-            context_.PostToIOContext([this]() mutable { SendMessageInternal(); });
+        switch (WaitForCompletion(*slot, settings, deadline)) {
+            case MessageWriteStatus::Success:
+                return SendResult::Accepted;
+            case MessageWriteStatus::Timeout:
+                return SendResult::Timeout;  // The message is never written
+            case MessageWriteStatus::Failure:
+            default:
+                return SendResult::Failed;
         }
+    }
 
-        bool result = future.get();  // Block until completion
-        return result;
+    void OnConnected() override {
+        if (!write_in_progress_) {
+            TryWriteNext();
+        }
     }
 
     void OnMessageWriteCompleted(MessageWriteStatus status) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        if (!active_send_) {
+        if (!write_in_progress_ || !write_queue_head_) {
             return;  // Spurious callback (should not happen)
         }
+        write_in_progress_ = false;
 
+        CompletionSlot* slot = PopWriteQueue();
         if (status == MessageWriteStatus::Success) {
-            context_.RecordMessageSent(send_payload_.message.size());
+            context_.RecordMessageSent(slot->message.View().size());
+            context_.RecordMessageLatency(write_started_ - slot->message.enqueue_time,
+                                          std::chrono::steady_clock::now() - write_started_);
         }
+        Complete(slot, status == MessageWriteStatus::Success);
 
-        MarkWriteComplete(status == MessageWriteStatus::Success);
+        TryWriteNext();
     }
 
   private:
-    void SendMessageInternal() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    // The calling thread's slot. A slot abandoned by a timed out send stays with the IO context
+    // until its write completes, so the thread takes a new one meanwhile.
+    static const std::shared_ptr<CompletionSlot>& AcquireThreadSlot() {
+        thread_local std::shared_ptr<CompletionSlot> slot;
+        if (!slot || slot->state.Load() != Idle) {
+            slot = std::make_shared<CompletionSlot>();
+        }
+        return slot;
+    }
+
+    // Waits for the slot's write and frees the slot, unless the deadline passed before the write
+    // started. A write that has started is waited for regardless of the deadline.
+    MessageWriteStatus WaitForCompletion(CompletionSlot& slot, const SyncSendSettings& settings,
+                                         std::optional<WaitableState::Clock::time_point> deadline) {
+        if (!slot.state.WaitWhile(InFlight, settings.spin_duration, deadline)) {
+            uint32_t expected = InFlight;
+            if (slot.state.CompareExchange(expected, Abandoned)) {
+                return MessageWriteStatus::Timeout;
+            }
+            // Claimed just as the wait timed out
+        }
+        // Claiming a slot does not wake its caller, which only sleeps through the write here
+        slot.state.WaitWhile(Writing, settings.spin_duration);
+
+        const bool succeeded = slot.state.Load() == Succeeded;
+        slot.state.Store(Idle);
+        return succeeded ? MessageWriteStatus::Success : MessageWriteStatus::Failure;
+    }
+
+    void Post(CompletionSlot* slot) {
+        slot->next = posted_.load(std::memory_order_relaxed);
+        while (!posted_.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        }
+
+        if (!drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+            context_.PostToIOContext([this]() { DrainPosted(); });
+        }
+    }
+
+    // Runs on the IO context
+    void DrainPosted() {
+        // Clear the flag before draining: anything posted after this point is either picked up
+        // below or schedules another drain
+        drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+        AppendToWriteQueue(posted_.exchange(nullptr, std::memory_order_acquire));
+
+        if (!write_in_progress_) {
+            TryWriteNext();
+        }
+    }
+
+    // Appends the stack of posted slots, newest first, in the order they were posted
+    void AppendToWriteQueue(CompletionSlot* posted) {
+        CompletionSlot* oldest_first = nullptr;
+        while (posted) {
+            CompletionSlot* next = posted->next;
+            posted->next = oldest_first;
+            oldest_first = posted;
+            posted = next;
+        }
 
-        if (!context_.IsClientConnected()) {
-            MarkWriteComplete(false);
+        if (!oldest_first) {
             return;
         }
+        if (write_queue_tail_) {
+            write_queue_tail_->next = oldest_first;
+        } else {
+            write_queue_head_ = oldest_first;
+        }
+        for (write_queue_tail_ = oldest_first; write_queue_tail_->next;
+             write_queue_tail_ = write_queue_tail_->next) {
+        }
+    }
 
-        bool accepted = context_.ClientSend(send_payload_.message);
-        if (!accepted) {
-            MarkWriteComplete(false);
+    CompletionSlot* PopWriteQueue() {
+        CompletionSlot* slot = write_queue_head_;
+        write_queue_head_ = slot->next;
+        if (!write_queue_head_) {
+            write_queue_tail_ = nullptr;
         }
-        // Success path will be handled in OnMessageWriteCompleted
+        slot->next = nullptr;
+        return slot;
     }
 
-    void MarkWriteComplete(bool status) {
-        if (!active_send_) {
-            return;  // Spurious callback (should not happen)
+    void TryWriteNext() {
+        while (write_queue_head_) {
+            if (!context_.IsClientConnected()) {
+                if (context_.GetSyncSendSettings().timeout) {
+                    return;  // Picked up again in OnConnected, unless the callers give up first
+                }
+                Complete(PopWriteQueue(), false);
+                continue;
+            }
+
+            uint32_t expected = InFlight;
+            if (!write_queue_head_->state.CompareExchangeQuietly(expected, Writing)) {
+                Complete(PopWriteQueue(), false);  // Abandoned by a caller that timed out
+                continue;
+            }
+
+            write_in_progress_ = true;
+            write_started_ = std::chrono::steady_clock::now();
+            if (context_.ClientSend(write_queue_head_->message)) {
+                return;  // Completed in OnMessageWriteCompleted
+            }
+            write_in_progress_ = false;
+            Complete(PopWriteQueue(), false);
         }
+    }
 
-        context_.DecrementCurrentQueueSize();
-        active_send_ = false;
-        SafeSetPromise(status);
-        send_payload_.message.clear();
-        cv_.notify_one();
+    void Complete(CompletionSlot* slot, bool succeeded) {
+        context_.DecrementCurrentQueueSize(slot->message.priority);
+        NotifyWritten(slot->message,
+                      succeeded ? MessageWriteStatus::Success : MessageWriteStatus::Failure);
+        context_.RecyclePayload(std::move(slot->message.payload));
+        Finish(slot, succeeded);
     }
 
-    void SafeSetPromise(bool value) {
-        // Guard against multiple sets in edge cases
-        try {
-            send_payload_.write_promise.set_value(value);
-        } catch (...) {
-            // Ignore if already set
+    // Hands the slot back to its caller, or frees it if the caller has timed out
+    static void Finish(CompletionSlot* slot, bool succeeded) {
+        // The message must be released before the slot can be used again. It has only been
+        // notified if its write was attempted.
+        NotifyWritten(slot->message, MessageWriteStatus::Failure);
+        slot->message = {};
+        const std::shared_ptr<CompletionSlot> keep_alive = std::move(slot->self);
+
+        // In flight if it failed before being claimed, in which case its caller may be giving up
+        // at the same time
+        uint32_t expected = slot->state.Load();
+        while (expected != Abandoned &&
+               !slot->state.CompareExchange(expected, succeeded ? Succeeded : Failed)) {
+        }
+        if (expected == Abandoned) {
+            slot->state.Store(Idle);
         }
     }
 
   private:
     ISendPolicyContext& context_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    bool active_send_{ false };
-    Payload send_payload_;
+
+    // Held by a caller for the duration of its send
+    std::timed_mutex turn_mutex_;
+
+    // Slots handed over by callers, newest first
+    std::atomic<CompletionSlot*> posted_{ nullptr };
+    std::atomic<bool> drain_scheduled_{ false };
+
+    // Only touched on the IO context
+    CompletionSlot* write_queue_head_{ nullptr };
+    CompletionSlot* write_queue_tail_{ nullptr };
+    bool write_in_progress_{ false };
+    std::chrono::steady_clock::time_point write_started_;
 };
 }  // namespace WS
@@ -0,0 +1,116 @@
+#include "Implementation/Beast/Tls/TlsContext.hpp"
+
+namespace WS {
+namespace {
+// Ex-data slots used to find the cache and the cache key from OpenSSL's new-session callback
+int GetContextIndex() {
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+int GetSessionKeyIndex() {
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+}  // namespace
+
+std::shared_ptr<TlsContext> TlsContext::Create(const std::string& additional_ca_pem) {
+    std::shared_ptr<TlsContext> context(new TlsContext());
+    if (!context->Initialize(additional_ca_pem)) {
+        return nullptr;
+    }
+    return context;
+}
+
+std::shared_ptr<TlsContext> TlsContext::GetDefault() {
+    static std::mutex mutex;
+    static std::shared_ptr<TlsContext> context;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!context) {
+        context = Create();  // Retried on next use if it failed
+    }
+    return context;
+}
+
+TlsContext::TlsContext() : ctx_(ssl::context::tlsv13_client) {}
+
+TlsContext::~TlsContext() {
+    for (auto& [key, session] : sessions_) {
+        SSL_SESSION_free(session);
+    }
+}
+
+bool TlsContext::Initialize(const std::string& additional_ca_pem) {
+    boost::system::error_code ec;
+    ctx_.set_verify_mode(ssl::verify_peer, ec);
+    if (ec) {
+        return false;
+    }
+
+#if _WIN32 || _WIN64
+    if (::SSL_CTX_load_verify_store(ctx_.native_handle(), "org.openssl.winstore://") == 0) {
+        return false;
+    }
+#else
+    // TODO: Make sure this works on non-Debian systems that have CA certs injected as env
+    // variable
+    ctx_.set_default_verify_paths(ec);
+    if (ec) {
+        return false;
+    }
+#endif
+
+    if (!additional_ca_pem.empty()) {
+        ctx_.add_certificate_authority(net::buffer(additional_ca_pem), ec);
+        if (ec) {
+            return false;
+        }
+    }
+
+    // Keep client sessions out of OpenSSL's internal cache; they are handed to OnNewSession and
+    // stored per host:port instead
+    SSL_CTX* native = ctx_.native_handle();
+    if (SSL_CTX_set_ex_data(native, GetContextIndex(), this) == 0) {
+        return false;
+    }
+    SSL_CTX_set_session_cache_mode(native,
+                                   SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(native, &TlsContext::OnNewSession);
+
+    return true;
+}
+
+void TlsContext::PrepareSessionResumption(SSL* ssl, const std::string& session_key) {
+    SSL_set_ex_data(ssl, GetSessionKeyIndex(), const_cast<std::string*>(&session_key));
+
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    auto it = sessions_.find(session_key);
+    if (it != sessions_.end()) {
+        SSL_set_session(ssl, it->second);  // Takes its own reference
+    }
+}
+
+int TlsContext::OnNewSession(SSL* ssl, SSL_SESSION* session) {
+    auto* self = static_cast<TlsContext*>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), GetContextIndex()));
+    auto* session_key =
+        static_cast<const std::string*>(SSL_get_ex_data(ssl, GetSessionKeyIndex()));
+    if (!self || !session_key) {
+        return 0;  // Not taking ownership; OpenSSL frees the session
+    }
+
+    self->StoreSession(*session_key, session);
+    return 1;
+}
+
+void TlsContext::StoreSession(const std::string& session_key, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+
+    auto [it, inserted] = sessions_.try_emplace(session_key, session);
+    if (!inserted) {
+        SSL_SESSION_free(it->second);
+        it->second = session;
+    }
+}
+}  // namespace WS
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Implementation/Beast/Common.hpp"
+
+namespace WS {
+// TLS client context shared by many connections. Trust anchors are loaded once when the context
+// is created, and sessions issued by servers are cached per host:port so that reconnects can
+// resume them instead of performing a full handshake.
+class TlsContext {
+  public:
+    // Returns nullptr if the context could not be configured. `additional_ca_pem` holds
+    // PEM-encoded CA certificates trusted on top of the system trust store.
+    static std::shared_ptr<TlsContext> Create(const std::string& additional_ca_pem = {});
+
+    // Process-wide context used by messengers unless configured otherwise. Created on first use.
+    static std::shared_ptr<TlsContext> GetDefault();
+
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    ssl::context& GetContext() { return ctx_; }
+
+    // Associates `ssl` with the session cache entry for `session_key` and, if a session is cached
+    // for it, offers that session for resumption. `session_key` must outlive `ssl`.
+    void PrepareSessionResumption(SSL* ssl, const std::string& session_key);
+
+  private:
+    TlsContext();
+
+    bool Initialize(const std::string& additional_ca_pem);
+
+    static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+    void StoreSession(const std::string& session_key, SSL_SESSION* session);
+
+  private:
+    ssl::context ctx_;
+
+    std::mutex sessions_mutex_;
+    std::unordered_map<std::string, SSL_SESSION*> sessions_;
+};
+}  // namespace WS
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "Implementation/Beast/Common.hpp"
+#include "Implementation/Beast/WriteCoalescingStream.hpp"
+#include "Implementation/Internal/ClientCallbackInterfaces.hpp"
+
+namespace WS {
+// Rate policy for the TCP layer that never limits, but reports every transfer to the client
+// callback. Sitting below TLS, it sees the actual bytes on the wire, including TLS records and
+// WebSocket framing, after compression.
+class WireTrafficRatePolicy {
+  public:
+    void SetObserver(IWebSocketClientCallback* observer) { observer_ = observer; }
+
+  private:
+    friend class beast::rate_policy_access;
+
+    std::size_t available_read_bytes() const noexcept {
+        return (std::numeric_limits<std::size_t>::max)();
+    }
+
+    std::size_t available_write_bytes() const noexcept {
+        return (std::numeric_limits<std::size_t>::max)();
+    }
+
+    void transfer_read_bytes(std::size_t bytes) {
+        if (observer_) {
+            observer_->OnWireBytesRead(bytes);
+        }
+    }
+
+    void transfer_write_bytes(std::size_t bytes) {
+        if (observer_) {
+            observer_->OnWireBytesWritten(bytes);
+        }
+    }
+
+    void on_timer() {}
+
+  private:
+    IWebSocketClientCallback* observer_{ nullptr };
+};
+
+// Executor a connection's IO runs on. Kept concrete: with net::any_io_executor every operation's
+// work tracking would allocate a type-erased copy of the strand.
+using StrandExecutor = net::strand<net::io_context::executor_type>;
+
+using TcpStream = beast::basic_stream<tcp, StrandExecutor, WireTrafficRatePolicy>;
+using TlsStream = ssl::stream<TcpStream>;
+// Batched frames are held back below the WebSocket layer and handed to TLS in one write
+using WebSocketStream = websocket::stream<WriteCoalescingStream<TlsStream>>;
+}  // namespace WS
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+
+#include "Implementation/Beast/Common.hpp"
+
+namespace WS {
+// Stream layer below the WebSocket stream that can hold writes back, so the frames of a batch go
+// down to TLS in one write instead of a record and a flush each.
+//
+// While writes are held, every write is copied into a buffer and completes right away. The first
+// write after `ReleaseWrites` sends the held bytes together with its own. Everything the WebSocket
+// stream writes goes through here in order, including control frames, so held frames never get
+// reordered. Only used on the stream's executor.
+template <typename NextLayerT>
+class WriteCoalescingStream {
+  private:
+    template <typename HandlerT>
+    class WriteOp : public beast::async_base<HandlerT, typename NextLayerT::executor_type> {
+      public:
+        template <typename HandlerArgT, typename ConstBufferSequence>
+        WriteOp(HandlerArgT&& handler, WriteCoalescingStream& stream,
+                const ConstBufferSequence& buffers)
+            : beast::async_base<HandlerT, typename NextLayerT::executor_type>(
+                  std::forward<HandlerArgT>(handler), stream.get_executor()),
+              stream_(stream),
+              size_(net::buffer_size(buffers)) {
+            stream_.held_.commit(net::buffer_copy(stream_.held_.prepare(size_), buffers));
+
+            if (stream_.holding_) {
+                this->complete(false, beast::error_code{}, size_);
+                return;
+            }
+
+            net::async_write(stream_.next_layer_, stream_.held_.data(), std::move(*this));
+        }
+
+        void operator()(beast::error_code ec, std::size_t bytes_flushed) {
+            stream_.last_flush_bytes_ = bytes_flushed;
+            stream_.held_.clear();
+            this->complete_now(ec, ec ? 0 : size_);
+        }
+
+      private:
+        WriteCoalescingStream& stream_;
+        const std::size_t size_;
+    };
+
+  public:
+    using next_layer_type = NextLayerT;
+    using executor_type = typename NextLayerT::executor_type;
+
+    template <typename... ArgsT>
+    explicit WriteCoalescingStream(ArgsT&&... args) : next_layer_(std::forward<ArgsT>(args)...) {}
+
+    executor_type get_executor() noexcept { return next_layer_.get_executor(); }
+
+    NextLayerT& next_layer() noexcept { return next_layer_; }
+    const NextLayerT& next_layer() const noexcept { return next_layer_; }
+
+    // Starts holding writes back. The held bytes only go out with the first write after
+    // `ReleaseWrites`, so it must be followed by one.
+    void HoldWrites() {
+        if (held_.size() == 0) {
+            last_flush_bytes_ = 0;
+        }
+        holding_ = true;
+    }
+    void ReleaseWrites() { holding_ = false; }
+
+    // Bytes held so far, i.e. the offset the next held write starts at
+    std::size_t GetHeldBytes() const { return held_.size(); }
+    // Held bytes the last flush handed to the next layer; all of them unless it failed
+    std::size_t GetLastFlushBytes() const { return last_flush_bytes_; }
+
+    template <typename MutableBufferSequence, typename ReadHandler>
+    auto async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler) {
+        return next_layer_.async_read_some(buffers, std::forward<ReadHandler>(handler));
+    }
+
+    template <typename ConstBufferSequence, typename WriteHandler>
+    auto async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler) {
+        return net::async_initiate<WriteHandler, void(beast::error_code, std::size_t)>(
+            [this](auto&& handler, const ConstBufferSequence& buffers) {
+                if (!holding_ && held_.size() == 0) {
+                    next_layer_.async_write_some(buffers, std::forward<decltype(handler)>(handler));
+                    return;
+                }
+                using HandlerT = std::decay_t<decltype(handler)>;
+                WriteOp<HandlerT>(std::forward<decltype(handler)>(handler), *this, buffers);
+            },
+            handler, buffers);
+    }
+
+  private:
+    NextLayerT next_layer_;
+    bool holding_{ false };
+    beast::flat_buffer held_;  // Keeps its capacity across batches
+    std::size_t last_flush_bytes_{ 0 };
+};
+
+template <typename NextLayerT>
+void teardown(beast::role_type role, WriteCoalescingStream<NextLayerT>& stream,
+              beast::error_code& ec) {
+    using beast::websocket::teardown;
+    teardown(role, stream.next_layer(), ec);
+}
+
+template <typename NextLayerT, typename TeardownHandler>
+void async_teardown(beast::role_type role, WriteCoalescingStream<NextLayerT>& stream,
+                    TeardownHandler&& handler) {
+    using beast::websocket::async_teardown;
+    async_teardown(role, stream.next_layer(), std::forward<TeardownHandler>(handler));
+}
+}  // namespace WS
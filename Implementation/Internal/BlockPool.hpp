@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace WS {
+// Free list of fixed-size memory blocks shared by all threads.
+//
+// Requests up to the block size are served from the free list, and their blocks are kept for reuse
+// once freed, up to `max_free_blocks`. Larger or over-aligned requests go to the global heap. Meant
+// for memory that is allocated on one thread and freed on another, such as handlers posted to an
+// IO context, which Asio's per-thread handler memory cache cannot recycle.
+class BlockPool {
+  public:
+    BlockPool(size_t block_size, size_t max_free_blocks)
+        : block_size_(block_size), max_free_blocks_(max_free_blocks) {
+        free_blocks_.reserve(max_free_blocks_);  // Freeing never allocates
+    }
+
+    ~BlockPool() {
+        for (void* block : free_blocks_) {
+            ::operator delete(block);
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* Allocate(size_t size, size_t alignment) {
+        if (!IsPooled(size, alignment)) {
+            return ::operator new(size, std::align_val_t(alignment));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_blocks_.empty()) {
+                void* block = free_blocks_.back();
+                free_blocks_.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(block_size_);
+    }
+
+    void Deallocate(void* pointer, size_t size, size_t alignment) {
+        if (!IsPooled(size, alignment)) {
+            ::operator delete(pointer, std::align_val_t(alignment));
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_blocks_.size() < max_free_blocks_) {
+                free_blocks_.push_back(pointer);
+                return;
+            }
+        }
+        ::operator delete(pointer);
+    }
+
+  private:
+    bool IsPooled(size_t size, size_t alignment) const {
+        return size <= block_size_ && alignment <= alignof(std::max_align_t);
+    }
+
+  private:
+    const size_t block_size_;
+    const size_t max_free_blocks_;
+
+    std::mutex mutex_;
+    std::vector<void*> free_blocks_;
+};
+
+// Standard allocator drawing from a BlockPool, which must outlive everything it allocates
+template <typename T>
+class BlockPoolAllocator {
+  public:
+    using value_type = T;
+
+    explicit BlockPoolAllocator(BlockPool& pool) noexcept : pool_(&pool) {}
+
+    template <typename U>
+    BlockPoolAllocator(const BlockPoolAllocator<U>& other) noexcept : pool_(other.pool_) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(pool_->Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        pool_->Deallocate(pointer, sizeof(T) * count, alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const BlockPoolAllocator<U>& other) const noexcept {
+        return pool_ == other.pool_;
+    }
+
+    template <typename U>
+    bool operator!=(const BlockPoolAllocator<U>& other) const noexcept {
+        return pool_ != other.pool_;
+    }
+
+  private:
+    template <typename U>
+    friend class BlockPoolAllocator;
+
+    BlockPool* pool_;
+};
+}  // namespace WS
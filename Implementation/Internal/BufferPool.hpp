@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace WS {
+// Pool of string buffers that keeps their capacity for reuse.
+//
+// Buffers are only taken back once Acquire has been called, so owners that never ask for pooled
+// buffers do not pay for recycling the ones they hand over. Buffers that have grown beyond
+// `max_buffer_capacity` are freed instead of kept. The pool only grows to as many buffers as are
+// released to it, up to `max_buffers`, so an idle connection does not pay for the limit. Safe to
+// use from any thread.
+class BufferPool {
+  public:
+    BufferPool(size_t max_buffers, size_t max_buffer_capacity)
+        : max_buffers_(max_buffers), max_buffer_capacity_(max_buffer_capacity) {}
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns an empty buffer with at least `capacity` bytes reserved
+    std::string Acquire(size_t capacity) {
+        std::string buffer;
+        if (max_buffers_ != 0) {
+            in_use_.store(true, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!buffers_.empty()) {
+                buffer = std::move(buffers_.back());
+                buffers_.pop_back();
+            }
+        }
+
+        buffer.reserve(capacity);
+        return buffer;
+    }
+
+    void Release(std::string&& buffer) {
+        // Short strings live inside the string object and have nothing worth keeping
+        if (!in_use_.load(std::memory_order_relaxed) || buffer.capacity() > max_buffer_capacity_ ||
+            buffer.capacity() <= std::string().capacity()) {
+            return;
+        }
+
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffers_.size() < max_buffers_) {
+            buffers_.push_back(std::move(buffer));
+        }
+    }
+
+  private:
+    const size_t max_buffers_;
+    const size_t max_buffer_capacity_;
+
+    std::atomic<bool> in_use_{ false };
+    std::mutex mutex_;
+    std::vector<std::string> buffers_;
+};
+}  // namespace WS
@@ -1,17 +1,35 @@
 #pragma once
 
+#include <chrono>
 #include <string_view>
 
 #include "Include/WebSocketMessenger.hpp"
 
 namespace WS {
+enum class ConnectPhase {
+    Resolve,
+    TcpConnect,
+    ProxyTunnel,
+    TlsHandshake,
+    WebSocketHandshake,
+};
+
 class IWebSocketClientCallback {
   public:
     virtual ~IWebSocketClientCallback() = default;
 
-    virtual void OnMessageReceived(std::string_view message) = 0;
+    virtual void OnMessageReceived(std::string_view message, MessageType type) = 0;
+    virtual void OnMessageFragmentReceived(std::string_view fragment, MessageType type,
+                                           bool is_final) = 0;
+    virtual void OnTlsHandshakeCompleted(bool session_resumed) = 0;
+    // A phase of establishing the connection completed successfully
+    virtual void OnConnectPhaseCompleted(ConnectPhase phase, std::chrono::nanoseconds duration) = 0;
     virtual void OnConnected() = 0;
     virtual void OnDisconnected(const ErrorDetails& error) = 0;
+
+    // Raw bytes moved through the socket, including TLS and WebSocket framing
+    virtual void OnWireBytesRead(size_t bytes) = 0;
+    virtual void OnWireBytesWritten(size_t bytes) = 0;
 };
 
 class IWriterOperator {
@@ -19,5 +37,10 @@ class IWriterOperator {
     virtual ~IWriterOperator() = default;
 
     virtual void OnMessageWriteCompleted(MessageWriteStatus status) = 0;
+    // Precedes the failed completion of a batched write whose first `messages_written` messages
+    // were written before the failure
+    virtual void OnBatchPartiallyWritten(size_t messages_written) = 0;
+    // A fragment of a streamed message has been written
+    virtual void OnMessageFragmentWritten(size_t bytes) = 0;
 };
 }  // namespace WS
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+#include "Implementation/Internal/ClientCallbackInterfaces.hpp"
+
+namespace WS {
+// Passes a client's callbacks on to its owner until the owner detaches, and drops them after that.
+//
+// Clients keep the relay alive, so a client that outlives its owner, such as one still closing when
+// the owner is destroyed from a handler on the client's own executor, does not call into freed
+// memory. Detaching and every callback happen on the client's executor, or once the client is gone.
+class ClientCallbackRelay : public IWebSocketClientCallback, public IWriterOperator {
+  public:
+    ClientCallbackRelay(IWebSocketClientCallback& callback, IWriterOperator& writer)
+        : callback_(&callback), writer_(&writer) {}
+
+    void Detach() {
+        callback_ = nullptr;
+        writer_ = nullptr;
+    }
+
+    // IWebSocketClientCallback
+    void OnMessageReceived(std::string_view message, MessageType type) override {
+        if (callback_) {
+            callback_->OnMessageReceived(message, type);
+        }
+    }
+    void OnMessageFragmentReceived(std::string_view fragment, MessageType type,
+                                   bool is_final) override {
+        if (callback_) {
+            callback_->OnMessageFragmentReceived(fragment, type, is_final);
+        }
+    }
+    void OnTlsHandshakeCompleted(bool session_resumed) override {
+        if (callback_) {
+            callback_->OnTlsHandshakeCompleted(session_resumed);
+        }
+    }
+    void OnConnectPhaseCompleted(ConnectPhase phase, std::chrono::nanoseconds duration) override {
+        if (callback_) {
+            callback_->OnConnectPhaseCompleted(phase, duration);
+        }
+    }
+    void OnConnected() override {
+        if (callback_) {
+            callback_->OnConnected();
+        }
+    }
+    void OnDisconnected(const ErrorDetails& error) override {
+        if (callback_) {
+            callback_->OnDisconnected(error);
+        }
+    }
+    void OnWireBytesRead(size_t bytes) override {
+        if (callback_) {
+            callback_->OnWireBytesRead(bytes);
+        }
+    }
+    void OnWireBytesWritten(size_t bytes) override {
+        if (callback_) {
+            callback_->OnWireBytesWritten(bytes);
+        }
+    }
+
+    // IWriterOperator
+    void OnMessageWriteCompleted(MessageWriteStatus status) override {
+        if (writer_) {
+            writer_->OnMessageWriteCompleted(status);
+        }
+    }
+    void OnBatchPartiallyWritten(size_t messages_written) override {
+        if (writer_) {
+            writer_->OnBatchPartiallyWritten(messages_written);
+        }
+    }
+    void OnMessageFragmentWritten(size_t bytes) override {
+        if (writer_) {
+            writer_->OnMessageFragmentWritten(bytes);
+        }
+    }
+
+  private:
+    IWebSocketClientCallback* callback_;
+    IWriterOperator* writer_;
+};
+}  // namespace WS
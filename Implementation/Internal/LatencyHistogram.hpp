@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "Include/WebSocketMessenger.hpp"
+
+namespace WS {
+// Lock-free latency histogram with log-linear buckets, in the style of HdrHistogram.
+//
+// Values below 32ns get a bucket each; every power of two above that is split into 16 equally
+// wide buckets, so a reported percentile is within ~3% of the recorded value. Values are tracked
+// up to ~68s and clamped beyond that. Recording is a couple of relaxed atomic increments, cheap
+// enough to leave enabled on every message.
+//
+// Record may be called from any thread. Snapshots taken while values are being recorded may miss
+// the most recent ones.
+class LatencyHistogram {
+  private:
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr unsigned MaxValueBits = 36;
+    static constexpr size_t SubBucketCount = size_t{ 1 } << SubBucketBits;
+    static constexpr size_t LinearBucketCount = SubBucketCount * 2;
+    static constexpr size_t BucketCount =
+        LinearBucketCount + (MaxValueBits - SubBucketBits - 1) * SubBucketCount;
+    static constexpr uint64_t MaxValue = (uint64_t{ 1 } << MaxValueBits) - 1;
+
+  public:
+    void Record(std::chrono::nanoseconds latency) {
+        const uint64_t value =
+            std::min<uint64_t>(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)),
+                               MaxValue);
+
+        buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Adds the values recorded by `other`, e.g. to report several histograms as one
+    void Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BucketCount; ++i) {
+            const uint64_t count = other.buckets_[i].load(std::memory_order_relaxed);
+            if (count != 0) {
+                buckets_[i].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+
+        const uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (other_max > max &&
+               !max_.compare_exchange_weak(max, other_max, std::memory_order_relaxed)) {
+        }
+    }
+
+    LatencyPercentiles GetPercentiles() const {
+        std::array<uint64_t, BucketCount> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        LatencyPercentiles percentiles;
+        percentiles.count = total;
+        if (total == 0) {
+            return percentiles;
+        }
+
+        const uint64_t max = max_.load(std::memory_order_relaxed);
+        percentiles.max = std::chrono::nanoseconds(max);
+        percentiles.p50 = ValueAtPercentile(counts, total, 0.5, max);
+        percentiles.p99 = ValueAtPercentile(counts, total, 0.99, max);
+        percentiles.p999 = ValueAtPercentile(counts, total, 0.999, max);
+        return percentiles;
+    }
+
+  private:
+    static size_t BucketIndex(uint64_t value) {
+        if (value < LinearBucketCount) {
+            return static_cast<size_t>(value);
+        }
+
+        // value lies in [2^msb, 2^(msb + 1)); its top SubBucketBits bits below the leading one
+        // select the sub-bucket
+        const unsigned msb = static_cast<unsigned>(std::bit_width(value)) - 1;
+        const unsigned shift = msb - SubBucketBits;
+        const size_t sub_bucket = static_cast<size_t>(value >> shift) - SubBucketCount;
+        return LinearBucketCount + (msb - SubBucketBits - 1) * SubBucketCount + sub_bucket;
+    }
+
+    // Midpoint of the range of values counted in a bucket
+    static uint64_t BucketValue(size_t index) {
+        if (index < LinearBucketCount) {
+            return index;
+        }
+
+        const size_t offset = index - LinearBucketCount;
+        const unsigned shift = static_cast<unsigned>(offset / SubBucketCount) + 1;
+        const uint64_t lower = (SubBucketCount + offset % SubBucketCount) << shift;
+        return lower + ((uint64_t{ 1 } << shift) >> 1);
+    }
+
+    static std::chrono::nanoseconds ValueAtPercentile(
+        const std::array<uint64_t, BucketCount>& counts, uint64_t total, double percentile,
+        uint64_t max) {
+        const uint64_t rank =
+            std::max<uint64_t>(static_cast<uint64_t>(static_cast<double>(total) * percentile), 1);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::chrono::nanoseconds(std::min(BucketValue(i), max));
+            }
+        }
+        return std::chrono::nanoseconds(max);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, BucketCount> buckets_{};
+    std::atomic<uint64_t> max_{ 0 };
+};
+}  // namespace WS
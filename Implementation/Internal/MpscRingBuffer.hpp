@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace WS {
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+//
+// Based on Dmitry Vyukov's bounded queue: every cell carries a sequence number that tells
+// producers and the consumer whether the cell is free or holds a published value, so producers
+// only contend on a single CAS of the enqueue position and never take a lock.
+//
+// TryPush may be called from any thread. TryPop must only be called from a single consumer thread
+// at a time.
+template <typename T>
+class MpscRingBuffer {
+  private:
+    static constexpr size_t CacheLineSize = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+  public:
+    // The capacity is rounded up to the next power of two.
+    explicit MpscRingBuffer(size_t min_capacity)
+        : capacity_(RoundUpToPowerOfTwo(min_capacity)),
+          mask_(capacity_ - 1),
+          cells_(std::make_unique<Cell[]>(capacity_)) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    // Returns false if the ring is full, in which case `value` is left untouched.
+    bool TryPush(T&& value) {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        for (;;) {
+            cell = &cells_[position & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence) -
+                              static_cast<std::intptr_t>(position);
+
+            if (diff == 0) {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                            std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if no published value is available.
+    bool TryPop(T& value) {
+        Cell& cell = cells_[dequeue_position_ & mask_];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+        if (static_cast<std::intptr_t>(sequence) -
+                static_cast<std::intptr_t>(dequeue_position_ + 1) <
+            0) {
+            return false;  // Empty, or the producer has not finished publishing yet
+        }
+
+        value = std::move(cell.value);
+        cell.sequence.store(dequeue_position_ + capacity_, std::memory_order_release);
+        ++dequeue_position_;
+        return true;
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+  private:
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+  private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producers and the consumer touch different positions; keep them on separate cache lines
+    alignas(CacheLineSize) std::atomic<size_t> enqueue_position_{ 0 };
+    alignas(CacheLineSize) size_t dequeue_position_{ 0 };
+};
+}  // namespace WS
@@ -0,0 +1,293 @@
+#include "Implementation/Internal/SegmentLog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+namespace WS {
+namespace {
+namespace ipc = boost::interprocess;
+
+// Every record starts with this header and is padded to the header alignment. The marker is
+// stored last when appending, so anything without it, such as the rest of a freshly created
+// (zero-filled) segment, is past the last record.
+struct RecordHeader {
+    uint32_t marker;
+    uint32_t size;  // Payload size
+    int64_t timestamp;
+    uint8_t type;
+    uint8_t acknowledged;
+};
+
+constexpr uint32_t RecordMarker = 0x57534c47;
+
+constexpr size_t RecordAlignment = alignof(RecordHeader);
+constexpr size_t MinSegmentSize = 4096;
+
+constexpr size_t RecordSpan(size_t payload_size) {
+    return (sizeof(RecordHeader) + payload_size + RecordAlignment - 1) & ~(RecordAlignment - 1);
+}
+
+RecordHeader* HeaderAt(char* data, size_t offset) {
+    return reinterpret_cast<RecordHeader*>(data + offset);
+}
+
+std::filesystem::path SegmentPath(const std::filesystem::path& directory, uint64_t sequence) {
+    char name[40];
+    std::snprintf(name, sizeof(name), "segment-%020llu.log",
+                  static_cast<unsigned long long>(sequence));
+    return directory / name;
+}
+
+std::optional<uint64_t> ParseSegmentSequence(const std::filesystem::path& path) {
+    const std::string name = path.filename().string();
+    unsigned long long sequence = 0;
+    int consumed = 0;
+    if (name.size() != 32 ||
+        std::sscanf(name.c_str(), "segment-%20llu.log%n", &sequence, &consumed) != 1 ||
+        consumed != static_cast<int>(name.size())) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(sequence);
+}
+}  // namespace
+
+std::unique_ptr<SegmentLog> SegmentLog::Open(const std::filesystem::path& directory,
+                                             size_t segment_size, uint64_t max_bytes) {
+    size_t size = std::max(segment_size, MinSegmentSize) & ~(RecordAlignment - 1);
+    size_t segments = 0;
+    if (max_bytes != 0) {
+        // The front segment is only deleted once appends have moved on to a new one
+        if (max_bytes / size < 2) {
+            size = static_cast<size_t>(max_bytes / 2) & ~(RecordAlignment - 1);
+            if (size < MinSegmentSize) {
+                return nullptr;
+            }
+        }
+        segments = static_cast<size_t>(std::min<uint64_t>(max_bytes / size, SIZE_MAX));
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SegmentLog> log(new SegmentLog(directory, size, segments));
+    if (!log->Recover()) {
+        return nullptr;
+    }
+    return log;
+}
+
+SegmentLog::SegmentLog(std::filesystem::path directory, size_t segment_size,
+                       size_t max_segments)
+    : directory_(std::move(directory)), segment_size_(segment_size), max_segments_(max_segments) {}
+
+size_t SegmentLog::MaxPayloadSize() const {
+    return std::min<size_t>(segment_size_ - sizeof(RecordHeader), UINT32_MAX);
+}
+
+bool SegmentLog::Recover() {
+    std::error_code error;
+    std::vector<uint64_t> sequences;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        if (const auto sequence = ParseSegmentSequence(entry.path())) {
+            sequences.push_back(*sequence);
+        }
+    }
+    if (error) {
+        return false;
+    }
+
+    std::sort(sequences.begin(), sequences.end());
+
+    // Count what is left to consume and find where the last segment ends. Segments in between are
+    // only mapped while they are scanned.
+    for (const uint64_t sequence : sequences) {
+        if (!AddSegment(sequence, false)) {
+            return false;
+        }
+
+        Segment& segment = segments_.back();
+        size_t offset = 0;
+        while (const size_t span = RecordSpanAt(segment, offset)) {
+            if (!HeaderAt(segment.Data(), offset)->acknowledged) {
+                ++unacknowledged_;
+            }
+            offset += span;
+        }
+
+        write_offset_ = offset;
+        if (segments_.size() > 2) {
+            Unmap(segments_[segments_.size() - 2]);
+        }
+    }
+
+    if (segments_.empty()) {
+        return AddSegment(0, true);
+    }
+    return true;
+}
+
+bool SegmentLog::AddSegment(uint64_t sequence, bool create) {
+    Segment segment;
+    segment.sequence = sequence;
+    segment.path = SegmentPath(directory_, sequence);
+
+    if (create) {
+        // Files are never reused, so a new segment always starts out zero-filled
+        std::FILE* file = std::fopen(segment.path.string().c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::fclose(file);
+
+        std::error_code error;
+        std::filesystem::resize_file(segment.path, segment_size_, error);
+        if (error) {
+            std::filesystem::remove(segment.path, error);
+            return false;
+        }
+    } else {
+        std::error_code error;
+        if (std::filesystem::file_size(segment.path, error) != segment_size_ || error) {
+            return false;  // Written with a different segment size
+        }
+    }
+
+    if (!Map(segment)) {
+        return false;
+    }
+
+    segments_.push_back(std::move(segment));
+    return true;
+}
+
+bool SegmentLog::Map(Segment& segment) {
+    if (segment.Data()) {
+        return true;
+    }
+
+    try {
+        segment.file = ipc::file_mapping(segment.path.string().c_str(), ipc::read_write);
+        segment.region = ipc::mapped_region(segment.file, ipc::read_write, 0, segment_size_);
+    } catch (const ipc::interprocess_exception&) {
+        Unmap(segment);
+        return false;
+    }
+    return true;
+}
+
+void SegmentLog::Unmap(Segment& segment) {
+    segment.region = ipc::mapped_region();
+    segment.file = ipc::file_mapping();
+}
+
+size_t SegmentLog::RecordSpanAt(const Segment& segment, size_t offset) const {
+    if (offset + sizeof(RecordHeader) > segment_size_) {
+        return 0;
+    }
+
+    RecordHeader* header = HeaderAt(segment.Data(), offset);
+    if (std::atomic_ref<uint32_t>(header->marker).load(std::memory_order_acquire) !=
+            RecordMarker ||
+        offset + RecordSpan(header->size) > segment_size_) {
+        return 0;  // The end, or garbage left by a torn write
+    }
+    return RecordSpan(header->size);
+}
+
+bool SegmentLog::Append(std::string_view payload, uint8_t type, int64_t timestamp) {
+    if (payload.size() > MaxPayloadSize()) {
+        return false;
+    }
+
+    const size_t span = RecordSpan(payload.size());
+    if (write_offset_ + span > segment_size_) {
+        if (max_segments_ != 0 && segments_.size() >= max_segments_) {
+            return false;
+        }
+        if (!AddSegment(segments_.back().sequence + 1, true)) {
+            return false;
+        }
+        if (segments_.size() > 2) {
+            Unmap(segments_[segments_.size() - 2]);
+        }
+        write_offset_ = 0;
+    } else if (!Map(segments_.back())) {
+        return false;  // The only segment, left unmapped by a failed Front
+    }
+
+    char* data = segments_.back().Data();
+    RecordHeader* header = HeaderAt(data, write_offset_);
+    header->size = static_cast<uint32_t>(payload.size());
+    header->timestamp = timestamp;
+    header->type = type;
+    header->acknowledged = 0;
+    std::memcpy(data + write_offset_ + sizeof(RecordHeader), payload.data(), payload.size());
+    std::atomic_ref<uint32_t>(header->marker).store(RecordMarker, std::memory_order_release);
+
+    write_offset_ += span;
+    ++unacknowledged_;
+    return true;
+}
+
+std::optional<SegmentLog::Record> SegmentLog::Front() {
+    while (true) {
+        // Mapping the next segment may have failed on an earlier call; it is retried until it
+        // succeeds, and the log stays where it is meanwhile
+        Segment& segment = segments_.front();
+        if (!Map(segment)) {
+            return std::nullopt;
+        }
+
+        const size_t span = RecordSpanAt(segment, read_offset_);
+        if (span == 0) {
+            // A segment is only finished once appends have moved on to the next one
+            if (segments_.size() == 1) {
+                return std::nullopt;
+            }
+
+            std::error_code error;
+            Unmap(segment);
+            std::filesystem::remove(segment.path, error);
+            segments_.pop_front();
+            read_offset_ = 0;
+            continue;
+        }
+
+        const RecordHeader* header = HeaderAt(segment.Data(), read_offset_);
+        if (header->acknowledged) {
+            read_offset_ += span;  // Consumed before a restart
+            continue;
+        }
+
+        Record record;
+        record.payload = std::string_view(segment.Data() + read_offset_ + sizeof(RecordHeader),
+                                          header->size);
+        record.type = header->type;
+        record.timestamp = header->timestamp;
+        return record;
+    }
+}
+
+void SegmentLog::Acknowledge() {
+    Segment& segment = segments_.front();
+    if (!segment.Data()) {
+        return;  // Front returned no record
+    }
+
+    const size_t span = RecordSpanAt(segment, read_offset_);
+    if (span == 0) {
+        return;
+    }
+
+    HeaderAt(segment.Data(), read_offset_)->acknowledged = 1;
+    read_offset_ += span;
+    --unacknowledged_;
+}
+}  // namespace WS
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace WS {
+// Append-only log of records in memory-mapped segment files of a fixed size.
+//
+// Records are appended at the back and consumed in order from the front. A record is marked as
+// acknowledged in place once it has been consumed, and a segment file is deleted as soon as the
+// front has moved past it, so the files on disk only ever hold the unacknowledged backlog plus
+// the partly consumed front segment. Only the front and back segments are mapped, which keeps
+// memory use independent of the backlog.
+//
+// A record is only marked complete once fully written, so a record torn by a crash mid-append is
+// ignored when the log is reopened. Unacknowledged records of a previous process are consumed
+// first. Records survive a process crash, but are only as safe from power loss as the OS page
+// cache.
+//
+// Not thread-safe.
+class SegmentLog {
+  public:
+    struct Record {
+        std::string_view payload;  // Valid until the record is acknowledged
+        uint8_t type{ 0 };
+        int64_t timestamp{ 0 };
+    };
+
+    // Opens the log in `directory`, creating the directory if needed. `max_bytes` limits the
+    // space the segment files take; 0 means no limit. The log needs room for 2 segments, so
+    // segments are made smaller if the limit cannot hold 2 of `segment_size`. Returns nullptr if
+    // the log cannot be opened or the limit cannot hold 2 segments of the minimum size.
+    static std::unique_ptr<SegmentLog> Open(const std::filesystem::path& directory,
+                                            size_t segment_size, uint64_t max_bytes = 0);
+
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    // Returns false if the record is larger than a segment can hold, or if it needs a new segment
+    // and that cannot be created or would exceed `max_bytes`.
+    bool Append(std::string_view payload, uint8_t type, int64_t timestamp);
+
+    // The oldest unacknowledged record, if any. Also nullopt while the segment it is in cannot be
+    // mapped; later calls try again.
+    std::optional<Record> Front();
+
+    // Acknowledges the record last returned by Front
+    void Acknowledge();
+
+    // Number of unacknowledged records
+    size_t Size() const { return unacknowledged_; }
+
+    size_t MaxPayloadSize() const;
+
+  private:
+    struct Segment {
+        uint64_t sequence{ 0 };
+        std::filesystem::path path;
+        boost::interprocess::file_mapping file;
+        boost::interprocess::mapped_region region;
+
+        char* Data() const { return static_cast<char*>(region.get_address()); }
+    };
+
+    SegmentLog(std::filesystem::path directory, size_t segment_size, size_t max_segments);
+
+    bool Recover();
+    bool AddSegment(uint64_t sequence, bool create);
+    bool Map(Segment& segment);
+    void Unmap(Segment& segment);
+
+    // Bytes taken by the record at `offset` of a mapped segment; 0 past the last record
+    size_t RecordSpanAt(const Segment& segment, size_t offset) const;
+
+  private:
+    const std::filesystem::path directory_;
+    const size_t segment_size_;
+    const size_t max_segments_;
+
+    std::deque<Segment> segments_;
+    size_t read_offset_{ 0 };   // Into the front segment
+    size_t write_offset_{ 0 };  // Into the back segment
+    size_t unacknowledged_{ 0 };
+};
+}  // namespace WS
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace WS {
+// A fixed set of statistics counters, sharded so concurrent writers do not share cache lines.
+//
+// Each thread writes to the shard picked by its thread index with relaxed increments, so the IO
+// thread and producer threads never bounce a cache line between cores on the hot path. A shard is
+// allocated by the first thread to write to it, so an instance only pays for the threads that
+// update it. Reads sum every shard and are meant for infrequent snapshots; a snapshot taken while
+// counters are being updated is not atomic across counters.
+//
+// CounterT is an enum whose values index the counters, with Count as the number of counters.
+template <typename CounterT, size_t CounterCount = static_cast<size_t>(CounterT::Count)>
+class ShardedCounters {
+  private:
+    static constexpr size_t CacheLineSize = 64;
+    static constexpr size_t ShardCount = 16;  // Power of two
+
+    struct alignas(CacheLineSize) Shard {
+        std::array<std::atomic<int64_t>, CounterCount> values{};
+    };
+
+  public:
+    ShardedCounters() = default;
+    ShardedCounters(const ShardedCounters&) = delete;
+    ShardedCounters& operator=(const ShardedCounters&) = delete;
+
+    ~ShardedCounters() {
+        for (std::atomic<Shard*>& shard : shards_) {
+            delete shard.load(std::memory_order_relaxed);
+        }
+    }
+
+    void Add(CounterT counter, int64_t amount = 1) {
+        LocalShard().values[static_cast<size_t>(counter)].fetch_add(amount,
+                                                                    std::memory_order_relaxed);
+    }
+
+    void Subtract(CounterT counter, int64_t amount = 1) { Add(counter, -amount); }
+
+    // Sum over all shards. Counters that go up and down, such as a queue size, may briefly read
+    // below zero when the two sides land on different shards; they are clamped to zero.
+    size_t Load(CounterT counter) const {
+        int64_t total = 0;
+        for (const std::atomic<Shard*>& slot : shards_) {
+            if (const Shard* shard = slot.load(std::memory_order_acquire)) {
+                total +=
+                    shard->values[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+            }
+        }
+        return total > 0 ? static_cast<size_t>(total) : 0;
+    }
+
+  private:
+    Shard& LocalShard() {
+        std::atomic<Shard*>& slot = shards_[ThreadIndex() & (ShardCount - 1)];
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) [[unlikely]] {
+            shard = CreateShard(slot);
+        }
+        return *shard;
+    }
+
+    // Threads sharing a slot may race to create its shard; all but the first discard theirs
+    static Shard* CreateShard(std::atomic<Shard*>& slot) {
+        Shard* shard = new Shard();
+        Shard* existing = nullptr;
+        if (slot.compare_exchange_strong(existing, shard, std::memory_order_acq_rel)) {
+            return shard;
+        }
+        delete shard;
+        return existing;
+    }
+
+    // Threads are numbered in order of their first update to counters of this type, so the first
+    // ShardCount threads are guaranteed distinct shards
+    static size_t ThreadIndex() {
+        // Constant-initialized, so reading it needs no thread_local guard check
+        constexpr size_t Unassigned = ~size_t{ 0 };
+        thread_local size_t index = Unassigned;
+        if (index == Unassigned) [[unlikely]] {
+            static std::atomic<size_t> next_index{ 0 };
+            index = next_index.fetch_add(1, std::memory_order_relaxed);
+        }
+        return index;
+    }
+
+  private:
+    std::array<std::atomic<Shard*>, ShardCount> shards_{};
+};
+}  // namespace WS
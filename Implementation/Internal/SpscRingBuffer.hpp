@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace WS {
+// Bounded lock-free single-producer / single-consumer ring buffer.
+//
+// The producer only writes the tail and the consumer only writes the head, so neither side ever
+// performs a read-modify-write. Each side caches the other's last seen position and only reloads
+// it when the ring looks full (producer) or empty (consumer), which keeps the shared cache lines
+// from bouncing on every operation.
+//
+// TryPush must only be called from one thread at a time, and likewise TryPop.
+template <typename T>
+class SpscRingBuffer {
+  private:
+    static constexpr size_t CacheLineSize = 64;
+
+  public:
+    // The capacity is rounded up to the next power of two.
+    explicit SpscRingBuffer(size_t min_capacity)
+        : capacity_(RoundUpToPowerOfTwo(min_capacity)),
+          mask_(capacity_ - 1),
+          values_(std::make_unique<T[]>(capacity_)) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Returns false if the ring is full, in which case `value` is left untouched.
+    bool TryPush(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_) {
+                return false;  // Full
+            }
+        }
+
+        values_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the ring is empty.
+    bool TryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;  // Empty
+            }
+        }
+
+        value = std::move(values_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Safe to call from the consumer; from any other thread it is a snapshot that may be stale
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // Exact on the consumer when only the consumer pops; otherwise a snapshot that may be stale
+    size_t Size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+  private:
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+  private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> values_;
+
+    // Producer side
+    alignas(CacheLineSize) std::atomic<size_t> tail_{ 0 };
+    size_t cached_head_{ 0 };
+
+    // Consumer side
+    alignas(CacheLineSize) std::atomic<size_t> head_{ 0 };
+    size_t cached_tail_{ 0 };
+};
+}  // namespace WS
@@ -0,0 +1,93 @@
+#include "Implementation/Internal/WaitableState.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <algorithm>
+#include <thread>
+#endif
+
+namespace WS {
+namespace {
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "The state is waited on through its address");
+
+// Time left until `deadline`, or nullopt without one
+std::optional<std::chrono::nanoseconds> Remaining(
+    std::optional<WaitableState::Clock::time_point> deadline) {
+    if (!deadline) {
+        return std::nullopt;
+    }
+    const std::chrono::nanoseconds remaining = *deadline - WaitableState::Clock::now();
+    return remaining.count() > 0 ? remaining : std::chrono::nanoseconds::zero();
+}
+}  // namespace
+
+#if defined(__linux__)
+bool WaitableState::SleepWhile(uint32_t value, std::optional<Clock::time_point> deadline) {
+    const std::optional<std::chrono::nanoseconds> remaining = Remaining(deadline);
+    timespec timeout{};
+    if (remaining) {
+        if (remaining->count() == 0) {
+            return false;
+        }
+        timeout.tv_sec = static_cast<time_t>(remaining->count() / 1'000'000'000);
+        timeout.tv_nsec = static_cast<long>(remaining->count() % 1'000'000'000);
+    }
+
+    // Returns at once if the state no longer equals `value`
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAIT_PRIVATE, value,
+            remaining ? &timeout : nullptr, nullptr, 0);
+    return true;
+}
+
+void WaitableState::WakeAll() {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state_), FUTEX_WAKE_PRIVATE, INT32_MAX,
+            nullptr, nullptr, 0);
+}
+#elif defined(_WIN32)
+bool WaitableState::SleepWhile(uint32_t value, std::optional<Clock::time_point> deadline) {
+    const std::optional<std::chrono::nanoseconds> remaining = Remaining(deadline);
+    DWORD timeout_ms = INFINITE;
+    if (remaining) {
+        if (remaining->count() == 0) {
+            return false;
+        }
+        // Rounded up, so a wait does not end before its deadline
+        timeout_ms = static_cast<DWORD>(
+            std::chrono::ceil<std::chrono::milliseconds>(*remaining).count());
+    }
+
+    // Returns at once if the state no longer equals `value`
+    ::WaitOnAddress(&state_, &value, sizeof(value), timeout_ms);
+    return true;
+}
+
+void WaitableState::WakeAll() { ::WakeByAddressAll(&state_); }
+#else
+// Without a timed wait on an address, waits with a deadline sleep in short steps
+bool WaitableState::SleepWhile(uint32_t value, std::optional<Clock::time_point> deadline) {
+    const std::optional<std::chrono::nanoseconds> remaining = Remaining(deadline);
+    if (!remaining) {
+        state_.wait(value);
+        return true;
+    }
+    if (remaining->count() == 0) {
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(
+        *remaining, std::chrono::microseconds(100)));
+    return true;
+}
+
+void WaitableState::WakeAll() { state_.notify_all(); }
+#endif
+}  // namespace WS
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace WS {
+// A 32-bit state that threads can block on until it changes.
+//
+// A wait first spins for a bounded time, which avoids a sleep and wake-up when the state changes
+// within a few microseconds, then sleeps on the state's address: a futex on Linux and
+// WaitOnAddress on Windows. Both take a timeout, so waits with a deadline sleep the same way.
+// Updates only make the wake-up call while a waiter sleeps.
+class WaitableState {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit WaitableState(uint32_t initial) : state_(initial) {}
+
+    uint32_t Load() const { return state_.load(); }
+
+    void Store(uint32_t value) {
+        state_.store(value);
+        NotifyAll();
+    }
+
+    // Wakes waiters if the state was updated
+    bool CompareExchange(uint32_t& expected, uint32_t desired) {
+        if (!state_.compare_exchange_strong(expected, desired)) {
+            return false;
+        }
+        NotifyAll();
+        return true;
+    }
+
+    // Updates the state without waking waiters, for a change no waiter needs to see right away.
+    // A waiter still sees it once it next checks the state.
+    bool CompareExchangeQuietly(uint32_t& expected, uint32_t desired) {
+        return state_.compare_exchange_strong(expected, desired);
+    }
+
+    // Blocks while the state equals `value`. Returns false if `deadline` passed first.
+    bool WaitWhile(uint32_t value, std::chrono::nanoseconds spin_duration,
+                   std::optional<Clock::time_point> deadline = std::nullopt) {
+        if (state_.load() != value) {
+            return true;
+        }
+
+        if (spin_duration.count() > 0) {
+            const auto spin_until = Clock::now() + spin_duration;
+            do {
+                if (state_.load(std::memory_order_relaxed) != value) {
+                    return true;
+                }
+            } while (Clock::now() < spin_until);
+        }
+
+        // Registering before checking the state pairs with NotifyAll checking for sleepers after
+        // updating it, so one of the two always sees the other
+        sleepers_.fetch_add(1);
+        bool changed = true;
+        while (state_.load() == value) {
+            if (!SleepWhile(value, deadline)) {
+                changed = state_.load() != value;
+                break;
+            }
+        }
+        sleepers_.fetch_sub(1);
+        return changed;
+    }
+
+  private:
+    // Sleeps until woken, possibly spuriously, unless the state differs from `value` on entry.
+    // Returns false if `deadline` has passed.
+    bool SleepWhile(uint32_t value, std::optional<Clock::time_point> deadline);
+    void WakeAll();
+
+    void NotifyAll() {
+        if (sleepers_.load() > 0) {
+            WakeAll();
+        }
+    }
+
+  private:
+    std::atomic<uint32_t> state_;
+    std::atomic<uint32_t> sleepers_{ 0 };
+};
+}  // namespace WS
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace WS {
+// Counts outstanding units of work (posted handlers, pending timers, live clients) so an owner
+// running on a shared executor can wait until nothing references it anymore.
+//
+// Work holds the tracker by shared_ptr rather than its owner. An owner that cannot wait for its
+// work, e.g. one destroyed from one of its own handlers, expires the tracker instead, and work
+// still queued checks `IsExpired` before touching the owner. Work running outside the owner's
+// executor touches the owner only between `TryEnter` and `Leave`, which `Expire` waits for.
+class WorkTracker {
+  public:
+    void Add() { outstanding_.fetch_add(1, std::memory_order_relaxed); }
+
+    void Remove() {
+        if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Taking the lock orders the notification after a waiter's check of the counter
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+    bool IsIdle() const { return outstanding_.load(std::memory_order_acquire) == 0; }
+
+    // Blocks until every unit of work added so far has been removed.
+    void WaitForIdle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return outstanding_.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Marks the owner as gone, once no work is between `TryEnter` and `Leave`.
+    void Expire() {
+        expired_.store(true);
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return entered_.load() == 0; });
+    }
+
+    bool IsExpired() const { return expired_.load(std::memory_order_acquire); }
+
+    // Returns whether the owner may be touched until the matching `Leave`.
+    bool TryEnter() {
+        entered_.fetch_add(1);
+        if (!expired_.load()) {
+            return true;
+        }
+        Leave();
+        return false;
+    }
+
+    void Leave() {
+        if (entered_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+  private:
+    std::atomic<size_t> outstanding_{ 0 };
+    std::atomic<size_t> entered_{ 0 };
+    std::atomic<bool> expired_{ false };
+    std::mutex mutex_;
+    std::condition_variable idle_cv_;
+};
+}  // namespace WS
@@ -1,19 +1,65 @@
+#include <stdexcept>
+
 #include "Implementation/Beast/Client/BeastClient.hpp"
 #include "Implementation/Beast/Factory/BeastClientFactory.hpp"
+#include "Implementation/Beast/Messenger/BeastAwaitableMessenger.hpp"
 #include "Implementation/Beast/Messenger/BeastMessenger.hpp"
+#include "Implementation/Beast/Messenger/BeastPooledMessenger.hpp"
+#include "Implementation/Beast/Runtime/BeastRuntime.hpp"
 #include "Implementation/Beast/SendPolicy/AsyncSendPolicy.hpp"
+#include "Implementation/Beast/SendPolicy/BatchSendPolicy.hpp"
+#include "Implementation/Beast/SendPolicy/DurableSendPolicy.hpp"
+#include "Implementation/Beast/SendPolicy/PipelinedSyncSendPolicy.hpp"
 #include "Implementation/Beast/SendPolicy/SyncSendPolicy.hpp"
+#include "Implementation/Beast/Tls/TlsContext.hpp"
 
 namespace WS {
+std::shared_ptr<IMessengerRuntime> CreateMessengerRuntime(const RuntimeConfig& config) {
+    std::shared_ptr<TlsContext> tls_context;
+    if (!config.additional_trusted_ca_pem.empty()) {
+        tls_context = TlsContext::Create(config.additional_trusted_ca_pem);
+        if (!tls_context) {
+            throw std::invalid_argument("Failed to load additional trusted CA certificates");
+        }
+    }
+
+    return std::make_shared<BeastRuntime>(config.io_thread_count, std::move(tls_context));
+}
+
+namespace {
+std::shared_ptr<BeastRuntime> ToBeastRuntime(std::shared_ptr<IMessengerRuntime> runtime) {
+    auto beast_runtime = std::dynamic_pointer_cast<BeastRuntime>(runtime);
+    if (runtime && !beast_runtime) {
+        throw std::invalid_argument("Runtime must be created with CreateMessengerRuntime");
+    }
+    return beast_runtime;
+}
+}  // namespace
+
 template <SendBehavior SendBehaviorT>
-std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger(IWebSocketMessengerCallback& callback,
-                                                              const ConnectionConfig& config) {
+std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime) {
+    auto beast_runtime = ToBeastRuntime(std::move(runtime));
+
     if constexpr (SendBehaviorT == SendBehavior::Sync) {
         return std::make_shared<BeastMessenger<SendBehaviorInternal::Sync, BeastClientFactory>>(
-            callback, config);
+            callback, config, nullptr, nullptr, std::move(beast_runtime));
     } else if constexpr (SendBehaviorT == SendBehavior::Async) {
         return std::make_shared<BeastMessenger<SendBehaviorInternal::Async, BeastClientFactory>>(
-            callback, config);
+            callback, config, nullptr, nullptr, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::Batched) {
+        return std::make_shared<BeastMessenger<SendBehaviorInternal::Batched, BeastClientFactory>>(
+            callback, config, nullptr, nullptr, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::PipelinedSync) {
+        return std::make_shared<
+            BeastMessenger<SendBehaviorInternal::PipelinedSync, BeastClientFactory>>(
+            callback, config, nullptr, nullptr, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::Durable) {
+        return std::make_shared<BeastMessenger<SendBehaviorInternal::Custom, BeastClientFactory>>(
+            callback, config, nullptr,
+            std::make_shared<DurableSendPolicyFactory>(config.durable_send_settings),
+            std::move(beast_runtime));
     } else {
         static_assert(always_false<SendBehaviorT>,
                       "Unsupported SendBehavior specified for CreateWebSocketMessenger");
@@ -21,8 +67,76 @@ std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger(IWebSocketMessenge
 }
 
 template std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger<SendBehavior::Sync>(
-    IWebSocketMessengerCallback& callback, const ConnectionConfig& config);
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime);
 
 template std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger<SendBehavior::Async>(
-    IWebSocketMessengerCallback& callback, const ConnectionConfig& config);
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger<SendBehavior::Batched>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger<SendBehavior::PipelinedSync>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger<SendBehavior::Durable>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime);
+
+template <SendBehavior SendBehaviorT>
+std::shared_ptr<IWebSocketMessenger> CreatePooledWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    const PoolSettings& pool, std::shared_ptr<IMessengerRuntime> runtime) {
+    auto beast_runtime = ToBeastRuntime(std::move(runtime));
+
+    if constexpr (SendBehaviorT == SendBehavior::Sync) {
+        return std::make_shared<
+            BeastPooledMessenger<SendBehaviorInternal::Sync, BeastClientFactory>>(
+            callback, config, pool, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::Async) {
+        return std::make_shared<
+            BeastPooledMessenger<SendBehaviorInternal::Async, BeastClientFactory>>(
+            callback, config, pool, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::Batched) {
+        return std::make_shared<
+            BeastPooledMessenger<SendBehaviorInternal::Batched, BeastClientFactory>>(
+            callback, config, pool, std::move(beast_runtime));
+    } else if constexpr (SendBehaviorT == SendBehavior::PipelinedSync) {
+        return std::make_shared<
+            BeastPooledMessenger<SendBehaviorInternal::PipelinedSync, BeastClientFactory>>(
+            callback, config, pool, std::move(beast_runtime));
+    } else {
+        static_assert(always_false<SendBehaviorT>,
+                      "Unsupported SendBehavior specified for CreatePooledWebSocketMessenger");
+    }
+}
+
+template std::shared_ptr<IWebSocketMessenger> CreatePooledWebSocketMessenger<SendBehavior::Sync>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    const PoolSettings& pool, std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger> CreatePooledWebSocketMessenger<SendBehavior::Async>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    const PoolSettings& pool, std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger>
+CreatePooledWebSocketMessenger<SendBehavior::Batched>(IWebSocketMessengerCallback& callback,
+                                                      const ConnectionConfig& config,
+                                                      const PoolSettings& pool,
+                                                      std::shared_ptr<IMessengerRuntime> runtime);
+
+template std::shared_ptr<IWebSocketMessenger>
+CreatePooledWebSocketMessenger<SendBehavior::PipelinedSync>(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    const PoolSettings& pool, std::shared_ptr<IMessengerRuntime> runtime);
+
+std::shared_ptr<IAwaitableWebSocketMessenger> CreateAwaitableWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime) {
+    return std::make_shared<BeastAwaitableMessenger<BeastClientFactory>>(
+        callback, config, ToBeastRuntime(std::move(runtime)));
+}
 }  // namespace WS
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <boost/asio/awaitable.hpp>
+
+#include "WebSocketMessenger.hpp"
+
+namespace WS {
+// A message returned by `IAwaitableWebSocketMessenger::AsyncReceive`
+struct ReceivedMessage {
+    std::string payload;
+    MessageType type{ MessageType::Text };
+};
+
+// Coroutine interface to a messenger, built on Boost.Asio awaitables. Sends are queued like with
+// SendBehavior::Async, and all `IWebSocketMessenger` methods behave as they do there.
+//
+// Awaiting coroutines are always resumed through their own executor, never inline on the
+// messenger's IO thread, so they may run on any executor, including a runtime's.
+class IAwaitableWebSocketMessenger : public IWebSocketMessenger {
+  public:
+    // Queues the message and completes once it has been written, without blocking a thread while
+    // it waits. Completes with MessageWriteStatus::Failure if the message was not accepted, was
+    // discarded from the queue, or could not be written, and with MessageWriteStatus::Timeout if
+    // its deadline passed before it was written.
+    //
+    // Under OverflowPolicy::BlockWithTimeout, a full queue blocks the calling thread like `Send`.
+    virtual boost::asio::awaitable<MessageWriteStatus> AsyncSend(std::string message,
+                                                                 SendOptions options = {}) = 0;
+
+    // Completes with the next received message, or nullopt once the messenger is closed. Messages
+    // arriving while no receive is pending are buffered; set `receive_flow_control` to bound the
+    // buffer. Several receives may be pending at a time; they complete in the order they were
+    // started.
+    virtual boost::asio::awaitable<std::optional<ReceivedMessage>> AsyncReceive() = 0;
+};
+
+// Received messages are delivered through `AsyncReceive` only, so `callback` is not passed them;
+// it still receives connection events and, with `streaming_receive_chunk_size` set, fragments.
+//
+// If `runtime` is not provided, the messenger runs on its own dedicated IO thread.
+std::shared_ptr<IAwaitableWebSocketMessenger> CreateAwaitableWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime = nullptr);
+}  // namespace WS
@@ -1,8 +1,15 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace WS {
 //
@@ -26,16 +33,222 @@ struct ServerSettings {
     std::optional<ProxySettings> proxy_settings;
 };
 
+// Send queue a message goes into, highest priority first. Only used by SendBehavior::Async and
+// SendBehavior::Batched; the other behaviors write messages in the order they are sent.
+enum class SendPriority : uint8_t {
+    Control,  // Heartbeats, cancels and the like
+    High,
+    Normal,
+    Bulk,
+};
+
+inline constexpr size_t SendPriorityCount = 4;
+
+// Every SendPriority has a queue of its own, and each write takes the highest priority that has a
+// message waiting. Once a priority has had `weight` writes in a row while lower priorities were
+// waiting, the next lower one waiting gets a write, so lower priorities are slowed down under load
+// but never starved. A weight of 0 never yields. Both arrays are indexed by SendPriority.
+struct SendLaneSettings {
+    // Queue limit per priority; 0 uses max_send_queue_size
+    std::array<size_t, SendPriorityCount> max_queue_size{};
+    std::array<size_t, SendPriorityCount> weight{ 0, 16, 4, 0 };
+};
+
+// Only used by SendBehavior::Batched
+struct BatchSettings {
+    // Limits for a single batched write. A message larger than max_batch_bytes is written alone.
+    size_t max_batch_bytes{ 64 * 1024 };
+    size_t max_batch_count{ 64 };
+    // If set, batched messages are joined into a single WebSocket message separated by the
+    // delimiter. Otherwise each message keeps its own frame, and the frames of a batch still
+    // share TLS records.
+    std::optional<std::string> delimiter;
+};
+
+// Decides what happens to a message sent while the send queue already holds
+// `max_send_queue_size` messages. Has no effect when the queue is unbounded.
+enum class OverflowPolicy {
+    DropNewest,         // Discard the message being sent
+    DropOldest,         // Accept the message and discard the oldest message not yet being written
+    BlockWithTimeout,   // Block the caller until space frees up or the block timeout expires
+    RejectImmediately,  // Refuse the message without queueing it
+};
+
+// permessage-deflate (RFC 7692) negotiation and tuning. The server may decline the extension or
+// answer with different parameters, in which case messages are sent uncompressed or with the
+// negotiated parameters.
+struct CompressionSettings {
+    bool enabled{ false };
+    // Sliding window sizes offered for each direction, 9..15
+    int client_max_window_bits{ 15 };
+    int server_max_window_bits{ 15 };
+    // Reset the compression context after every message, trading ratio for memory
+    bool client_no_context_takeover{ false };
+    bool server_no_context_takeover{ false };
+    int compression_level{ 8 };  // 0..9
+    int mem_level{ 4 };          // 1..9
+    // Outgoing messages smaller than this are sent uncompressed
+    size_t min_message_size{ 64 };
+};
+
+// Decides what happens to a received message when the receive dispatch queue is full
+enum class ReceiveOverflowPolicy {
+    PauseReading,  // Stop reading from the socket until the queue has drained to half its
+                   // capacity, so TCP flow control slows the peer down
+    DropNewest,    // Discard the message. Fragmented messages are discarded whole: once the first
+                   // fragment is queued, the rest wait for room as with PauseReading.
+};
+
+// Runs a task, e.g. by posting it to a thread pool. It must eventually run every task it is given.
+using DispatchExecutor = std::function<void(std::function<void()>)>;
+
+// Delivery of received messages off the IO thread. Only used if `executor` is set.
+struct ReceiveDispatchSettings {
+    // Runs the message callbacks (`OnMessageReceived`, `OnBinaryMessageReceived` and
+    // `OnMessageFragment`) instead of the IO thread, so a slow consumer does not hold up reads and
+    // writes. Messages are handed over in order through a bounded queue, and the callbacks of one
+    // messenger are invoked one at a time, in order. Connection events stay on the IO thread.
+    DispatchExecutor executor;
+    size_t queue_capacity{ 1024 };
+    ReceiveOverflowPolicy overflow_policy{ ReceiveOverflowPolicy::PauseReading };
+};
+
+// Automatic read-side flow control. Received bytes count as unprocessed while they wait in the
+// receive dispatch queue or, with an awaitable messenger, for `AsyncReceive`. Reading from the
+// socket stops once `high_watermark_bytes` are unprocessed, so the kernel buffers fill and the
+// server is held back by TCP flow control, and resumes once at most `low_watermark_bytes` are.
+// Disabled if `high_watermark_bytes` is 0.
+struct ReceiveFlowControlSettings {
+    size_t high_watermark_bytes{ 0 };
+    size_t low_watermark_bytes{ 0 };
+};
+
+// Only used by SendBehavior::Sync
+struct SyncSendSettings {
+    // How long a caller busy-waits for its write to complete before going to sleep. Spinning
+    // spends a core to avoid the wake-up latency when writes complete within microseconds.
+    std::chrono::microseconds spin_duration{ 0 };
+    // If set, `Send` gives up on a message whose write has not started after this long and
+    // returns SendResult::Timeout; that message is never sent. A write that has started is waited
+    // for. Messages sent while disconnected wait for the connection until then, instead of
+    // failing at once.
+    std::optional<std::chrono::milliseconds> timeout;
+};
+
+// Payload buffers handed out by `IWebSocketMessenger::AcquireSendBuffer`
+struct SendBufferPoolSettings {
+    // Buffers kept for reuse once their message has been written; 0 disables the pool
+    size_t max_buffers{ 1024 };
+    // Buffers that have grown beyond this are freed instead of kept
+    size_t max_buffer_capacity{ 64 * 1024 };
+};
+
+// Only used by SendBehavior::Durable
+struct DurableSendSettings {
+    // Directory holding the send log; created if missing. Messages left in it by an earlier
+    // messenger are sent first. Must not be used by two messengers at the same time.
+    std::string directory;
+    // Size of each log file. A message larger than a file can hold is dropped.
+    size_t segment_size{ 64 * 1024 * 1024 };
+    // Disk space the log may take; once it is used up, further sends are dropped until queued
+    // messages have been written. 0 means no limit. The log needs room for 2 files, so files are
+    // made smaller if it cannot hold 2 of `segment_size`; opening fails below 8 KiB.
+    uint64_t max_disk_bytes{ 0 };
+};
+
 struct ConnectionConfig {
     ServerSettings server_settings;
     const bool enable_tls{ true };  // non-secure is not supported
     int critical_failure_threshold{ 5 };
+    // For SendBehavior::PipelinedSync, the number of callers whose messages are in the pipeline;
+    // further callers wait for one of them to complete. For SendBehavior::Async and
+    // SendBehavior::Batched, the limit of each priority's queue unless `send_lanes` sets one.
     size_t max_send_queue_size{ 1024 };
+    OverflowPolicy send_queue_overflow_policy{ OverflowPolicy::DropNewest };
+    std::chrono::milliseconds send_queue_block_timeout{ 100 };
+    // Deadline of messages sent without `SendOptions::deadline`, relative to when they are sent
+    std::optional<std::chrono::milliseconds> send_ttl;
+    // Capacity reserved up front for the receive buffer. Messages up to this size are received
+    // without any allocation; the buffer keeps whatever capacity larger messages grow it to.
+    size_t read_buffer_initial_capacity{ 64 * 1024 };
+    // Largest incoming message accepted; a larger message fails the connection. 0 means no limit.
+    uint64_t read_message_max{ 16 * 1024 * 1024 };
+    // If set, incoming messages are not buffered whole but handed to `OnMessageFragment` in
+    // chunks of at most this many bytes, so the receive buffer never grows beyond it. 0 lets the
+    // implementation pick a chunk size.
+    std::optional<size_t> streaming_receive_chunk_size;
+    // Largest fragment written for a message sent with `SendStream`; bounds the memory a
+    // streamed message holds while it is being written
+    size_t streaming_send_chunk_size{ 64 * 1024 };
+    SendBufferPoolSettings send_buffer_pool;
+    SendLaneSettings send_lanes;
+    BatchSettings batch_settings;
+    SyncSendSettings sync_send_settings;
+    DurableSendSettings durable_send_settings;
+    ReceiveDispatchSettings receive_dispatch;
+    ReceiveFlowControlSettings receive_flow_control;
+    CompressionSettings compression;
 };
 
 enum class SendBehavior {
     Sync,
     Async,
+    // Blocks like Sync, but concurrent callers are pipelined instead of waiting for each other.
+    // Each caller returns once its own message has been written, in call order.
+    PipelinedSync,
+    // Queues like Async, but coalesces queued messages into as few writes as possible
+    Batched,
+    // Queues every message in a log on disk and writes them from there in order, so the backlog
+    // is not bounded by memory and outlives the process: messages not yet written when the
+    // connection drops, or when the process stops, are sent once a connection is up again,
+    // including by a later messenger using the same DurableSendSettings::directory. A message is
+    // only removed from the log once its write completes, so one whose write was interrupted by
+    // a disconnect is sent again. Streamed messages are rejected; priorities, conflation and
+    // deadlines are ignored. Not supported by pooled messengers.
+    Durable,
+};
+
+// Synchronous outcome of handing a message to the messenger
+enum class SendResult {
+    Accepted,  // Queued for sending (Async, Batched, Durable) or written to the socket (Sync)
+    Dropped,   // Discarded because the send queue was full
+    Rejected,  // Refused: the messenger is closed or not ready, or the queue was full under
+               // OverflowPolicy::RejectImmediately
+    Timeout,   // The send queue stayed full for the whole block timeout, or a Sync send did not
+               // start within SyncSendSettings::timeout and was dropped
+    Failed,    // The write was attempted but failed (Sync)
+};
+
+// WebSocket data frame opcode used for a message
+enum class MessageType {
+    Text,    // Payload must be valid UTF-8
+    Binary,  // Arbitrary bytes
+};
+
+// Immutable payload that can be handed to any number of messengers without copying, e.g. to
+// broadcast one message over many connections
+using SharedPayload = std::shared_ptr<const std::string>;
+
+// Per-message options for `Send` / `TrySend`
+struct SendOptions {
+    MessageType type{ MessageType::Text };
+    SendPriority priority{ SendPriority::Normal };
+    // Used by pooled messengers with PoolBalancing::KeyHash, which send messages with the same key
+    // over the same connection so they keep their order, and by `conflate`
+    std::optional<uint64_t> key;
+    // Only used by SendBehavior::Async and SendBehavior::Batched, together with `key`. The message
+    // replaces a queued message with the same key and priority whose write has not started yet,
+    // and takes over its place in the queue; the replaced message completes with
+    // MessageWriteStatus::Failure. Queues then hold at most one such message per key, so e.g. a
+    // reconnect only catches up on the latest value of every key instead of its whole history.
+    // Such messages are accepted even when the queue is full, so a stale value is never written in
+    // place of the newest one.
+    bool conflate{ false };
+    // Only used by SendBehavior::Async and SendBehavior::Batched. A message whose write has not
+    // started by then, e.g. because the connection was down, is discarded instead, reported
+    // through `OnMessageExpired` and completes with MessageWriteStatus::Timeout. Defaults to
+    // `ConnectionConfig::send_ttl` after the message was sent.
+    std::optional<std::chrono::steady_clock::time_point> deadline;
 };
 
 enum class MessageWriteStatus {
@@ -49,12 +262,75 @@ struct ErrorDetails {
     int code{ 0 };  // Error code, if applicable
 };
 
+struct RuntimeConfig {
+    // Number of IO threads shared by all messengers created with the runtime
+    size_t io_thread_count{ 1 };
+    // PEM-encoded CA certificates trusted in addition to the system trust store by messengers
+    // created with the runtime, e.g. to reach a test server with a self-signed certificate.
+    // Such a runtime keeps its own TLS session cache.
+    std::string additional_trusted_ca_pem;
+};
+
 struct ConnectionStats {
     size_t total_messages_sent{ 0 };
     size_t total_messages_received{ 0 };
     size_t total_bytes_sent{ 0 };
     size_t total_bytes_received{ 0 };
     size_t current_send_queue_size{ 0 };
+    // Messages discarded by the overflow policy (DropNewest, DropOldest, or block timeout)
+    size_t total_messages_dropped{ 0 };
+    // The two above per SendPriority, indexed by it
+    std::array<size_t, SendPriorityCount> current_send_queue_size_by_priority{};
+    std::array<size_t, SendPriorityCount> total_messages_dropped_by_priority{};
+    // Messages refused under OverflowPolicy::RejectImmediately
+    size_t total_messages_rejected{ 0 };
+    // Queued messages replaced by a newer one with the same key, see SendOptions::conflate
+    size_t total_messages_conflated{ 0 };
+    // Queued messages discarded unwritten because their deadline passed
+    size_t total_messages_expired{ 0 };
+    // TLS handshakes performed, and how many of them resumed a cached session instead of
+    // performing a full handshake
+    size_t total_tls_handshakes{ 0 };
+    size_t total_tls_sessions_resumed{ 0 };
+    // Bytes actually written to / read from the socket, including TLS and WebSocket framing and
+    // after compression
+    size_t total_wire_bytes_sent{ 0 };
+    size_t total_wire_bytes_received{ 0 };
+    // Received messages waiting for the dispatch executor and those discarded under
+    // ReceiveOverflowPolicy::DropNewest (only used with `receive_dispatch`), and how often reading
+    // was paused automatically, by a full dispatch queue or by `receive_flow_control`.
+    size_t current_receive_queue_size{ 0 };
+    size_t total_received_messages_dropped{ 0 };
+    size_t total_receive_pauses{ 0 };
+    // Only used with `receive_flow_control`
+    size_t current_unprocessed_receive_bytes{ 0 };
+    // Message bytes per wire byte (total_bytes_* / total_wire_bytes_*). Above 1 when compression
+    // saves more than the framing overhead costs; 0 until anything was transferred.
+    double send_compression_ratio{ 0 };
+    double receive_compression_ratio{ 0 };
+};
+
+// Distribution of one latency, accumulated since the messenger was created. Percentiles are
+// approximate, within a few percent of the recorded values.
+struct LatencyPercentiles {
+    size_t count{ 0 };
+    std::chrono::nanoseconds p50{ 0 };
+    std::chrono::nanoseconds p99{ 0 };
+    std::chrono::nanoseconds p999{ 0 };
+    std::chrono::nanoseconds max{ 0 };
+};
+
+struct LatencyStats {
+    // Per message: from being accepted by `Send` until its write started
+    LatencyPercentiles queue_wait;
+    // Per message: from the start of its write until the write completed
+    LatencyPercentiles write;
+    // Per successful connection attempt, for each phase of establishing the connection
+    LatencyPercentiles dns_resolve;
+    LatencyPercentiles tcp_connect;
+    LatencyPercentiles proxy_tunnel;  // HTTP CONNECT exchange; only when a proxy is used
+    LatencyPercentiles tls_handshake;
+    LatencyPercentiles websocket_handshake;
 };
 
 //
@@ -65,8 +341,27 @@ class IWebSocketMessengerCallback {
   public:
     virtual ~IWebSocketMessengerCallback() = default;
 
+    // Called for text messages, and for binary messages unless `OnBinaryMessageReceived` is
+    // overridden. The view is only valid for the duration of the call.
     virtual void OnMessageReceived(std::string_view message) = 0;
 
+    // Called for binary messages. The span is only valid for the duration of the call.
+    virtual void OnBinaryMessageReceived(std::span<const std::byte> message) {
+        OnMessageReceived(
+            std::string_view(reinterpret_cast<const char*>(message.data()), message.size()));
+    }
+
+    // Called instead of the two callbacks above when `streaming_receive_chunk_size` is set. A
+    // message arrives as a sequence of fragments, the last one with `is_final` set; the final
+    // fragment may be empty. The view is only valid for the duration of the call.
+    virtual void OnMessageFragment(std::string_view /*fragment*/, MessageType /*type*/,
+                                   bool /*is_final*/) {}
+
+    // Called on the IO thread for a queued message that was discarded without being written
+    // because its deadline passed, see `SendOptions::deadline`. `message` is empty for a message
+    // sent with `SendStream`. The view is only valid for the duration of the call.
+    virtual void OnMessageExpired(std::string_view /*message*/, MessageType /*type*/) {}
+
     virtual void OnConnected() = 0;
     virtual void OnDisconnected(const ErrorDetails& error) = 0;
 
@@ -80,6 +375,32 @@ class IWebSocketMessengerCallback {
     virtual void SignalCriticalFailure() = 0;
 };
 
+// Supplies the payload of a message sent with `IWebSocketMessenger::SendStream`. All methods are
+// called from the messenger's IO context thread and must not block.
+class IMessageStreamProducer {
+  public:
+    virtual ~IMessageStreamProducer() = default;
+
+    // Copies the next part of the message into `chunk` and returns the number of bytes copied.
+    // Set `is_last` once the returned bytes end the message. Returning 0 without `is_last` means
+    // no data is available yet; writing then waits for the `resume` function passed to
+    // `OnWriteStarted`.
+    virtual size_t ReadChunk(std::span<std::byte> chunk, bool& is_last) = 0;
+
+    // Called before the first `ReadChunk` with a function that makes the messenger call
+    // `ReadChunk` again after it returned no data. It may be called from any thread, and must be
+    // called once more data is available; calls while writing is not waiting for data, or after
+    // the message has ended, do nothing.
+    virtual void OnWriteStarted(std::function<void()> /*resume*/) {}
+
+    // Called after each fragment has been written, with the message bytes written so far.
+    virtual void OnProgress(size_t /*bytes_written*/, bool /*is_complete*/) {}
+
+    // Called if the connection fails mid-message. The message is not retried, since part of it
+    // has already been consumed.
+    virtual void OnAborted() {}
+};
+
 class IWebSocketMessenger {
   public:
     virtual ~IWebSocketMessenger() = default;
@@ -87,18 +408,60 @@ class IWebSocketMessenger {
     // Schedules the connection to the server.
     virtual bool Open() = 0;
 
-    // Sends a message asynchronously. Returns true if the message was accepted for sending.
-    // Even if the send queue is full, the function will return true and the message will be
-    // dropped silently.
-    virtual bool Send(std::string&& message) = 0;
+    // Returns an empty buffer with at least `capacity` bytes reserved, from the messenger's pool
+    // of payload buffers if one is free. Fill it and pass it to `Send` or `TrySend`; once the
+    // message has been written its buffer goes back to the pool, so a steady stream of messages
+    // sent this way does not allocate. Buffers are only pooled once this has been called. May be
+    // called from any thread.
+    virtual std::string AcquireSendBuffer(size_t capacity = 0) = 0;
+
+    // Sends a message asynchronously. Returns true if the message was accepted for sending, and
+    // false if it was dropped or refused according to the configured overflow policy.
+    //
+    // The string is used as an owned byte buffer; set `options.type` to MessageType::Binary to
+    // send arbitrary bytes.
+    virtual bool Send(std::string&& message, const SendOptions& options = {}) = 0;
+
+    // Copies `message` and sends it, as a binary message unless `options` says otherwise.
+    virtual bool Send(std::span<const std::byte> message,
+                      const SendOptions& options = { MessageType::Binary }) = 0;
+
+    // Sends a shared payload. The messenger only holds a reference until the payload has been
+    // written, and writes it straight from the shared buffer. A null payload is refused.
+    virtual bool Send(SharedPayload message, const SendOptions& options = {}) = 0;
+
+    // Same as `Send`, but reports why a message was not accepted. The outcome is decided before
+    // the message is queued, so callers can apply backpressure.
+    virtual SendResult TrySend(std::string&& message, const SendOptions& options = {}) = 0;
+    virtual SendResult TrySend(SharedPayload message, const SendOptions& options = {}) = 0;
+
+    // Queues a message whose payload is pulled from `producer` once it reaches the front of the
+    // send queue, and written as a sequence of fragments of at most `streaming_send_chunk_size`
+    // bytes. Messages queued behind it are written after its final fragment. Control frames keep
+    // flowing between fragments, so keep-alives are not held up by a long transfer.
+    virtual SendResult SendStream(std::shared_ptr<IMessageStreamProducer> producer,
+                                  const SendOptions& options = {}) = 0;
+
+    // Stops reading from the socket until `ResumeReceive`, e.g. while the application's
+    // downstream is saturated. The server is then held back by TCP flow control instead of the
+    // messages piling up in memory. A message already being read may still be delivered, and the
+    // pause carries over reconnects. Both may be called from any thread once the messenger is
+    // open, including from callbacks.
+    virtual void PauseReceive() = 0;
+    virtual void ResumeReceive() = 0;
 
     // Closes the connection and stops the messenger. This is a blocking call and will return
-    // only after all internal resources are cleaned up.
+    // only after all internal resources are cleaned up. Called from a callback, it returns right
+    // away and the connection finishes closing in the background; the messenger may still be
+    // destroyed there.
     virtual void Close() = 0;
 
     // Gets the current connection statistics.
     virtual ConnectionStats GetConnectionStats() const = 0;
 
+    // Gets latency distributions for sent messages and connection setup.
+    virtual LatencyStats GetLatencyStats() const = 0;
+
     // Schedule a reconnect attempt if and only if the messenger has already signalled a critical
     // failure via `SignalCriticalFailure` callback.
     //
@@ -111,7 +474,56 @@ class IWebSocketMessenger {
     virtual bool ScheduleReconnect(std::optional<ServerSettings> settings) = 0;
 };
 
+// Pool of IO threads that can be shared by many messengers. By default every messenger owns a
+// dedicated IO thread; messengers created with a runtime are instead spread across its threads,
+// each running on its own strand. Messengers keep the runtime alive, so it can be released by the
+// caller at any time.
+//
+// Callbacks of messengers sharing a runtime thread are invoked from that thread, so a slow
+// callback delays every messenger on it.
+class IMessengerRuntime {
+  public:
+    virtual ~IMessengerRuntime() = default;
+
+    virtual size_t GetThreadCount() const = 0;
+};
+
+// Throws std::invalid_argument if `additional_trusted_ca_pem` cannot be loaded.
+std::shared_ptr<IMessengerRuntime> CreateMessengerRuntime(const RuntimeConfig& config);
+
+// If `runtime` is not provided, the messenger runs on its own dedicated IO thread.
+// For SendBehavior::Durable, throws std::invalid_argument if the send log cannot be opened.
+template <SendBehavior SendBehaviorT>
+std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    std::shared_ptr<IMessengerRuntime> runtime = nullptr);
+
+// How a pooled messenger picks the connection a message is sent over
+enum class PoolBalancing {
+    RoundRobin,   // The connected members in turn, evenly while some are disconnected
+    LeastQueued,  // The shorter send queue of two connected members picked at random
+    KeyHash,      // The member `SendOptions::key` hashes to; round-robin for messages without a key
+};
+
+struct PoolSettings {
+    size_t connection_count{ 4 };
+    PoolBalancing balancing{ PoolBalancing::RoundRobin };
+};
+
+// Opens `pool.connection_count` connections to `config.server_settings` and spreads sends across
+// them, so one logical stream is not limited to what a single TLS connection on one IO thread can
+// encrypt. Messages are only kept in order per connection; use PoolBalancing::KeyHash where order
+// matters.
+//
+// Each connection reconnects on its own. OnConnected is reported when the first connection is up
+// and OnDisconnected when the last one goes down; SignalCriticalFailure is reported per connection,
+// and ScheduleReconnect reconnects every connection that has signalled one. Callbacks of different
+// connections may run concurrently on different IO threads. Stats are summed over the connections.
+//
+// If `runtime` is not provided, the pool runs on its own runtime with an IO thread per connection.
+// Throws std::invalid_argument if `pool.connection_count` is 0.
 template <SendBehavior SendBehaviorT>
-std::shared_ptr<IWebSocketMessenger> CreateWebSocketMessenger(IWebSocketMessengerCallback& callback,
-                                                              const ConnectionConfig& config);
+std::shared_ptr<IWebSocketMessenger> CreatePooledWebSocketMessenger(
+    IWebSocketMessengerCallback& callback, const ConnectionConfig& config,
+    const PoolSettings& pool, std::shared_ptr<IMessengerRuntime> runtime = nullptr);
 }  // namespace WS
@@ -0,0 +1,250 @@
+#include "bench_server.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "Implementation/Beast/Common.hpp"
+
+namespace HermesBench {
+namespace {
+struct Credentials {
+    std::string certificate_pem;
+    std::string private_key_pem;
+};
+
+std::string ReadBio(BIO* bio) {
+    char* data = nullptr;
+    const long size = BIO_get_mem_data(bio, &data);
+    return std::string(data, static_cast<size_t>(size));
+}
+
+bool AddExtension(X509* certificate, int nid, const char* value) {
+    X509V3_CTX context;
+    X509V3_set_ctx_nodb(&context);
+    X509V3_set_ctx(&context, certificate, certificate, nullptr, nullptr, 0);
+
+    X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &context, nid, value);
+    if (!extension) {
+        return false;
+    }
+    const bool added = X509_add_ext(certificate, extension, -1) == 1;
+    X509_EXTENSION_free(extension);
+    return added;
+}
+
+// Self-signed P-256 certificate for "localhost" and 127.0.0.1, valid for a day
+bool GenerateCredentials(Credentials& credentials) {
+    EVP_PKEY* key = nullptr;
+    EVP_PKEY_CTX* key_context = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    const bool key_generated =
+        key_context && EVP_PKEY_keygen_init(key_context) == 1 &&
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_context, NID_X9_62_prime256v1) == 1 &&
+        EVP_PKEY_keygen(key_context, &key) == 1;
+    EVP_PKEY_CTX_free(key_context);
+    if (!key_generated) {
+        return false;
+    }
+
+    X509* certificate = X509_new();
+    X509_NAME* name = certificate ? X509_get_subject_name(certificate) : nullptr;
+    bool signed_ok =
+        name && X509_set_version(certificate, 2) == 1 &&
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1) == 1 &&
+        X509_gmtime_adj(X509_getm_notBefore(certificate), -60) &&
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60) &&
+        X509_set_pubkey(certificate, key) == 1 &&
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                   reinterpret_cast<const unsigned char*>("localhost"), -1, -1,
+                                   0) == 1 &&
+        X509_set_issuer_name(certificate, name) == 1 &&
+        AddExtension(certificate, NID_basic_constraints, "critical,CA:TRUE") &&
+        AddExtension(certificate, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1") &&
+        X509_sign(certificate, key, EVP_sha256()) > 0;
+
+    BIO* certificate_bio = BIO_new(BIO_s_mem());
+    BIO* key_bio = BIO_new(BIO_s_mem());
+    signed_ok = signed_ok && certificate_bio && key_bio &&
+                PEM_write_bio_X509(certificate_bio, certificate) == 1 &&
+                PEM_write_bio_PrivateKey(key_bio, key, nullptr, nullptr, 0, nullptr, nullptr) == 1;
+    if (signed_ok) {
+        credentials.certificate_pem = ReadBio(certificate_bio);
+        credentials.private_key_pem = ReadBio(key_bio);
+    }
+
+    BIO_free(certificate_bio);
+    BIO_free(key_bio);
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+    return signed_ok;
+}
+
+class Session : public std::enable_shared_from_this<Session> {
+  public:
+    Session(tcp::socket&& socket, ssl::context& ssl_context, BenchServer& server)
+        : ws_(std::move(socket), ssl_context), server_(server) {}
+
+    void Run() {
+        ws_.next_layer().async_handshake(
+            ssl::stream_base::server,
+            beast::bind_front_handler(&Session::OnTlsHandshake, shared_from_this()));
+    }
+
+  private:
+    void OnTlsHandshake(beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        ws_.read_message_max(0);
+        ws_.async_accept(beast::bind_front_handler(&Session::OnAccept, shared_from_this()));
+    }
+
+    void OnAccept(beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+        Read();
+    }
+
+    void Read() {
+        ws_.async_read(buffer_, beast::bind_front_handler(&Session::OnRead, shared_from_this()));
+    }
+
+    void OnRead(beast::error_code ec, size_t) {
+        if (ec) {
+            return;
+        }
+
+        const net::const_buffer data = buffer_.data();
+        server_.RecordMessage(data.data(), data.size());
+
+        if (server_.GetMode() == ServerMode::Sink) {
+            buffer_.consume(buffer_.size());
+            Read();
+            return;
+        }
+
+        ws_.text(ws_.got_text());
+        ws_.async_write(buffer_.data(),
+                        beast::bind_front_handler(&Session::OnWrite, shared_from_this()));
+    }
+
+    void OnWrite(beast::error_code ec, size_t) {
+        if (ec) {
+            return;
+        }
+        buffer_.consume(buffer_.size());
+        Read();
+    }
+
+  private:
+    websocket::stream<ssl::stream<tcp::socket>> ws_;
+    beast::flat_buffer buffer_;
+    BenchServer& server_;
+};
+}  // namespace
+
+std::unique_ptr<BenchServer> BenchServer::Start(size_t thread_count) {
+    std::unique_ptr<BenchServer> server(new BenchServer());
+    if (!server->Initialize(thread_count)) {
+        return nullptr;
+    }
+    return server;
+}
+
+BenchServer::BenchServer()
+    : ssl_context_(ssl::context::tlsv13_server),
+      latency_(std::make_unique<WS::LatencyHistogram>()) {}
+
+BenchServer::~BenchServer() {
+    ioc_.stop();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool BenchServer::Initialize(size_t thread_count) {
+    Credentials credentials;
+    if (!GenerateCredentials(credentials)) {
+        return false;
+    }
+    certificate_pem_ = credentials.certificate_pem;
+
+    beast::error_code ec;
+    ssl_context_.use_certificate_chain(net::buffer(credentials.certificate_pem), ec);
+    if (!ec) {
+        ssl_context_.use_private_key(net::buffer(credentials.private_key_pem),
+                                     ssl::context::file_format::pem, ec);
+    }
+    if (ec) {
+        return false;
+    }
+
+    acceptor_ = std::make_unique<tcp::acceptor>(net::make_strand(ioc_));
+    const tcp::endpoint endpoint(net::ip::make_address("127.0.0.1"), 0);
+    acceptor_->open(endpoint.protocol(), ec);
+    if (!ec) {
+        acceptor_->bind(endpoint, ec);
+    }
+    if (!ec) {
+        acceptor_->listen(net::socket_base::max_listen_connections, ec);
+    }
+    if (ec) {
+        return false;
+    }
+    port_ = acceptor_->local_endpoint().port();
+
+    Accept();
+
+    for (size_t i = 0; i < (thread_count > 0 ? thread_count : 1); ++i) {
+        threads_.emplace_back([this]() { ioc_.run(); });
+    }
+    return true;
+}
+
+void BenchServer::Accept() {
+    acceptor_->async_accept(net::make_strand(ioc_), [this](beast::error_code ec,
+                                                           tcp::socket socket) {
+        if (!ec) {
+            socket.set_option(tcp::no_delay(true), ec);
+            std::make_shared<Session>(std::move(socket), ssl_context_, *this)->Run();
+        }
+        Accept();
+    });
+}
+
+void BenchServer::ResetMeasurement() {
+    messages_received_.store(0);
+    bytes_received_.store(0);
+    latency_ = std::make_unique<WS::LatencyHistogram>();
+}
+
+void BenchServer::RecordMessage(const void* data, size_t size) {
+    if (size >= sizeof(int64_t)) {
+        int64_t sent_at = 0;
+        std::memcpy(&sent_at, data, sizeof(sent_at));
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+        latency_->Record(std::chrono::nanoseconds(now - sent_at));
+    }
+
+    bytes_received_.fetch_add(size, std::memory_order_relaxed);
+    messages_received_.fetch_add(1, std::memory_order_release);
+}
+
+void StampMessage(std::string& message) {
+    if (message.size() < sizeof(int64_t)) {
+        return;
+    }
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    std::memcpy(message.data(), &now, sizeof(now));
+}
+}  // namespace HermesBench
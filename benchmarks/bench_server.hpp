@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+
+#include "Implementation/Internal/LatencyHistogram.hpp"
+
+namespace HermesBench {
+// What the server does with the messages it receives
+enum class ServerMode {
+    Sink,  // Count and discard
+    Echo,  // Count and send back with the same opcode
+};
+
+// In-process TLS WebSocket server on 127.0.0.1 used as the benchmark peer. It presents a freshly
+// generated self-signed certificate for "localhost", which clients must trust explicitly.
+//
+// Every message of at least 8 bytes is expected to start with the sender's steady_clock time in
+// nanoseconds; the server records the one-way latency from that timestamp on arrival.
+class BenchServer {
+  public:
+    // Returns nullptr if the certificate could not be generated or the port not bound.
+    static std::unique_ptr<BenchServer> Start(size_t thread_count);
+
+    ~BenchServer();
+
+    BenchServer(const BenchServer&) = delete;
+    BenchServer& operator=(const BenchServer&) = delete;
+
+    uint16_t GetPort() const { return port_; }
+    const std::string& GetCertificatePem() const { return certificate_pem_; }
+
+    void SetMode(ServerMode mode) { mode_.store(mode); }
+    ServerMode GetMode() const { return mode_.load(); }
+
+    // Starts a new measurement. Must only be called while no messages are in flight.
+    void ResetMeasurement();
+
+    size_t GetMessagesReceived() const { return messages_received_.load(); }
+    size_t GetBytesReceived() const { return bytes_received_.load(); }
+    WS::LatencyPercentiles GetOneWayLatency() const { return latency_->GetPercentiles(); }
+
+    // Called by sessions
+    void RecordMessage(const void* data, size_t size);
+
+  private:
+    BenchServer();
+
+    bool Initialize(size_t thread_count);
+    void Accept();
+
+  private:
+    boost::asio::io_context ioc_;
+    boost::asio::ssl::context ssl_context_;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor_;
+    std::vector<std::thread> threads_;
+
+    std::string certificate_pem_;
+    uint16_t port_{ 0 };
+
+    std::atomic<ServerMode> mode_{ ServerMode::Sink };
+    std::atomic<size_t> messages_received_{ 0 };
+    std::atomic<size_t> bytes_received_{ 0 };
+    std::unique_ptr<WS::LatencyHistogram> latency_;
+};
+
+// Writes the current steady_clock time into the first 8 bytes of `message`, if it is that long.
+void StampMessage(std::string& message);
+}  // namespace HermesBench
@@ -0,0 +1,349 @@
+// Offline throughput and latency benchmark for Hermes.
+//
+// Starts an in-process TLS WebSocket server on localhost and drives Sync, PipelinedSync and Async
+// messengers through message size, producer thread and connection count sweeps, then measures
+// round trips per message size. Results are printed to stdout as JSON; progress goes to stderr.
+//
+// Usage: hermes-bench [--quick]
+
+#include <WebSocketMessenger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Implementation/Internal/LatencyHistogram.hpp"
+#include "bench_server.hpp"
+
+namespace {
+using namespace HermesBench;
+
+constexpr std::chrono::seconds ConnectTimeout{ 10 };
+constexpr std::chrono::seconds RunTimeout{ 120 };
+
+// Messages carry a raw timestamp, which is not valid UTF-8, so they go out as binary frames
+const WS::SendOptions BinaryMessage{ WS::MessageType::Binary };
+
+struct BenchOptions {
+    // Bytes sent per throughput run; the message count is derived from it within the limits
+    size_t bytes_per_run{ 256 * 1024 * 1024 };
+    size_t min_messages{ 64 };
+    size_t max_messages{ 200'000 };
+    size_t round_trips{ 2'000 };
+};
+
+struct RunSpec {
+    std::string scenario;
+    WS::SendBehavior behavior{ WS::SendBehavior::Async };
+    size_t message_size{ 0 };
+    size_t producers{ 1 };
+    size_t connections{ 1 };
+};
+
+struct RunResult {
+    RunSpec spec;
+    size_t messages{ 0 };
+    double seconds{ 0 };
+    bool completed{ false };
+    WS::LatencyPercentiles latency;
+};
+
+class BenchCallback : public WS::IWebSocketMessengerCallback {
+  public:
+    void OnMessageReceived(std::string_view) override {
+        messages_received_.fetch_add(1, std::memory_order_release);
+    }
+    void OnConnected() override { connected_.store(true); }
+    void OnDisconnected(const WS::ErrorDetails&) override { connected_.store(false); }
+    void SignalCriticalFailure() override {}
+
+    bool IsConnected() const { return connected_.load(); }
+    size_t GetMessagesReceived() const {
+        return messages_received_.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::atomic<bool> connected_{ false };
+    std::atomic<size_t> messages_received_{ 0 };
+};
+
+const char* ToString(WS::SendBehavior behavior) {
+    switch (behavior) {
+        case WS::SendBehavior::Sync:
+            return "sync";
+        case WS::SendBehavior::Async:
+            return "async";
+        case WS::SendBehavior::Batched:
+            return "batched";
+        case WS::SendBehavior::PipelinedSync:
+            return "pipelined_sync";
+    }
+    return "unknown";
+}
+
+// A set of connected messengers sharing one runtime that trusts the benchmark server
+class MessengerGroup {
+  public:
+    MessengerGroup(const BenchServer& server, WS::SendBehavior behavior, size_t connections) {
+        WS::RuntimeConfig runtime_config;
+        runtime_config.io_thread_count =
+            std::clamp<size_t>(connections, 1, std::max(std::thread::hardware_concurrency(), 1u));
+        runtime_config.additional_trusted_ca_pem = server.GetCertificatePem();
+        runtime_ = WS::CreateMessengerRuntime(runtime_config);
+
+        WS::ConnectionConfig config;
+        config.server_settings.host = "localhost";
+        config.server_settings.port = server.GetPort();
+        config.server_settings.target = "/";
+        // Apply backpressure instead of letting the queue grow without bound
+        config.max_send_queue_size = 1024;
+        config.send_queue_overflow_policy = WS::OverflowPolicy::BlockWithTimeout;
+        config.send_queue_block_timeout = std::chrono::seconds(10);
+        config.read_message_max = 0;
+
+        for (size_t i = 0; i < connections; ++i) {
+            callbacks_.push_back(std::make_unique<BenchCallback>());
+            messengers_.push_back(Create(behavior, *callbacks_.back(), config));
+            messengers_.back()->Open();
+        }
+    }
+
+    ~MessengerGroup() {
+        for (auto& messenger : messengers_) {
+            messenger->Close();
+        }
+    }
+
+    bool WaitForConnections() const {
+        const auto deadline = std::chrono::steady_clock::now() + ConnectTimeout;
+        for (const auto& callback : callbacks_) {
+            while (!callback->IsConnected()) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return true;
+    }
+
+    size_t Size() const { return messengers_.size(); }
+    WS::IWebSocketMessenger& Get(size_t index) { return *messengers_[index]; }
+    const BenchCallback& GetCallback(size_t index) const { return *callbacks_[index]; }
+
+  private:
+    std::shared_ptr<WS::IWebSocketMessenger> Create(WS::SendBehavior behavior,
+                                                    BenchCallback& callback,
+                                                    const WS::ConnectionConfig& config) {
+        switch (behavior) {
+            case WS::SendBehavior::Sync:
+                return WS::CreateWebSocketMessenger<WS::SendBehavior::Sync>(callback, config,
+                                                                           runtime_);
+            case WS::SendBehavior::Batched:
+                return WS::CreateWebSocketMessenger<WS::SendBehavior::Batched>(callback, config,
+                                                                              runtime_);
+            case WS::SendBehavior::PipelinedSync:
+                return WS::CreateWebSocketMessenger<WS::SendBehavior::PipelinedSync>(
+                    callback, config, runtime_);
+            case WS::SendBehavior::Async:
+            default:
+                return WS::CreateWebSocketMessenger<WS::SendBehavior::Async>(callback, config,
+                                                                            runtime_);
+        }
+    }
+
+  private:
+    std::shared_ptr<WS::IMessengerRuntime> runtime_;
+    std::vector<std::unique_ptr<BenchCallback>> callbacks_;
+    std::vector<std::shared_ptr<WS::IWebSocketMessenger>> messengers_;
+};
+
+// Sends messages from `producers` threads spread over all connections into the sink server.
+// Latency is one-way, from just before `Send` until the server read the message.
+RunResult RunThroughput(BenchServer& server, const RunSpec& spec, const BenchOptions& options) {
+    RunResult result;
+    result.spec = spec;
+    result.messages = std::clamp(options.bytes_per_run / std::max<size_t>(spec.message_size, 1),
+                                 options.min_messages, options.max_messages);
+    result.messages -= result.messages % spec.producers;
+
+    server.SetMode(ServerMode::Sink);
+    MessengerGroup group(server, spec.behavior, spec.connections);
+    if (!group.WaitForConnections()) {
+        return result;
+    }
+    server.ResetMeasurement();
+
+    const size_t per_producer = result.messages / spec.producers;
+    std::atomic<bool> start{ false };
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < spec.producers; ++p) {
+        producers.emplace_back([&, p]() {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < per_producer; ++i) {
+                std::string message(spec.message_size, 'x');
+                StampMessage(message);
+                group.Get((p + i) % group.Size()).Send(std::move(message), BinaryMessage);
+            }
+        });
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    const auto deadline = started + RunTimeout;
+    while (server.GetMessagesReceived() < result.messages &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.completed = server.GetMessagesReceived() >= result.messages;
+    result.latency = server.GetOneWayLatency();
+    return result;
+}
+
+// Sends one message at a time over a single connection and waits for its echo
+RunResult RunRoundTrip(BenchServer& server, const RunSpec& spec, const BenchOptions& options) {
+    RunResult result;
+    result.spec = spec;
+    result.messages = options.round_trips;
+
+    server.SetMode(ServerMode::Echo);
+    MessengerGroup group(server, spec.behavior, 1);
+    if (!group.WaitForConnections()) {
+        return result;
+    }
+    server.ResetMeasurement();
+
+    WS::LatencyHistogram round_trips;
+    const BenchCallback& callback = group.GetCallback(0);
+    const std::string payload(spec.message_size, 'x');
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto deadline = started + RunTimeout;
+    for (size_t i = 0; i < result.messages; ++i) {
+        const size_t expected = callback.GetMessagesReceived() + 1;
+        std::string message(payload);
+        StampMessage(message);
+        const auto sent_at = std::chrono::steady_clock::now();
+        group.Get(0).Send(std::move(message), BinaryMessage);
+
+        while (callback.GetMessagesReceived() < expected) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return result;
+            }
+            std::this_thread::yield();
+        }
+        round_trips.Record(std::chrono::steady_clock::now() - sent_at);
+    }
+
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.completed = true;
+    result.latency = round_trips.GetPercentiles();
+    return result;
+}
+
+void PrintResult(const RunResult& result, bool last) {
+    const double messages_per_second =
+        result.seconds > 0 ? static_cast<double>(result.messages) / result.seconds : 0;
+    const double megabytes_per_second =
+        messages_per_second * static_cast<double>(result.spec.message_size) / (1024 * 1024);
+
+    std::cout << "    {\"scenario\": \"" << result.spec.scenario << "\", \"behavior\": \""
+              << ToString(result.spec.behavior) << "\", \"message_size\": "
+              << result.spec.message_size << ", \"producers\": " << result.spec.producers
+              << ", \"connections\": " << result.spec.connections
+              << ", \"messages\": " << result.messages
+              << ", \"completed\": " << (result.completed ? "true" : "false")
+              << ", \"seconds\": " << result.seconds
+              << ", \"msgs_per_sec\": " << messages_per_second
+              << ", \"mb_per_sec\": " << megabytes_per_second << ", \"latency_ns\": {\"count\": "
+              << result.latency.count << ", \"p50\": " << result.latency.p50.count()
+              << ", \"p99\": " << result.latency.p99.count()
+              << ", \"p999\": " << result.latency.p999.count()
+              << ", \"max\": " << result.latency.max.count() << "}}" << (last ? "" : ",")
+              << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            options.bytes_per_run /= 16;
+            options.max_messages /= 10;
+            options.min_messages = 16;
+            options.round_trips /= 10;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    auto server = BenchServer::Start(std::max(std::thread::hardware_concurrency() / 2, 1u));
+    if (!server) {
+        std::cerr << "Failed to start the benchmark server" << std::endl;
+        return 1;
+    }
+
+    const std::vector<size_t> message_sizes = { 16, 256, 4 * 1024, 64 * 1024, 1024 * 1024 };
+    const std::vector<size_t> producer_counts = { 1, 2, 4, 8 };
+    const std::vector<size_t> connection_counts = { 1, 4, 16, 64 };
+    const WS::SendBehavior behaviors[] = { WS::SendBehavior::Sync, WS::SendBehavior::PipelinedSync,
+                                           WS::SendBehavior::Async };
+
+    std::vector<RunSpec> throughput_runs;
+    std::vector<RunSpec> round_trip_runs;
+    for (WS::SendBehavior behavior : behaviors) {
+        for (size_t size : message_sizes) {
+            throughput_runs.push_back({ "message_size", behavior, size, 1, 1 });
+            round_trip_runs.push_back({ "round_trip", behavior, size, 1, 1 });
+        }
+        for (size_t producers : producer_counts) {
+            throughput_runs.push_back({ "producers", behavior, 256, producers, 1 });
+        }
+        for (size_t connections : connection_counts) {
+            // A blocking messenger needs a producer per connection to keep every one busy
+            const bool blocking = behavior == WS::SendBehavior::Sync ||
+                                  behavior == WS::SendBehavior::PipelinedSync;
+            const size_t producers = blocking ? connections : 1;
+            throughput_runs.push_back({ "connections", behavior, 256, producers, connections });
+        }
+    }
+
+    std::vector<RunResult> results;
+    for (const RunSpec& spec : throughput_runs) {
+        std::cerr << spec.scenario << " " << ToString(spec.behavior) << " size="
+                  << spec.message_size << " producers=" << spec.producers
+                  << " connections=" << spec.connections << std::endl;
+        results.push_back(RunThroughput(*server, spec, options));
+    }
+    for (const RunSpec& spec : round_trip_runs) {
+        std::cerr << spec.scenario << " " << ToString(spec.behavior) << " size="
+                  << spec.message_size << std::endl;
+        results.push_back(RunRoundTrip(*server, spec, options));
+    }
+
+    std::cout << "{\n  \"results\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        PrintResult(results[i], i + 1 == results.size());
+    }
+    std::cout << "  ]\n}" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Counts heap allocations per sent message on the messenger's send path.
+//
+// Replaces the global allocation functions with counting ones. Messages are sent to an in-process
+// sink server after a warm-up that lets queues, buffers and pools reach their steady-state size.
+// Only the sending thread and the messenger's IO thread are counted, so the count covers the
+// caller building its payload, the hand-off to the IO thread and the write, but not the server.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "Include/WebSocketMessenger.hpp"
+#include "bench_server.hpp"
+
+namespace {
+std::atomic<size_t> g_allocations{ 0 };
+thread_local bool t_counted = false;
+
+void* CountedAllocate(size_t size) {
+    if (t_counted) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* CountedAllocateAligned(size_t size, std::align_val_t alignment) {
+    if (t_counted) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    const size_t align = static_cast<size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+}  // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocate(size);
+}
+void* operator new[](size_t size) {
+    return CountedAllocate(size);
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedAllocateAligned(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return CountedAllocateAligned(size, alignment);
+}
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+using HermesBench::BenchServer;
+using HermesBench::ServerMode;
+
+constexpr size_t WarmupMessages = 20'000;
+constexpr size_t MeasuredMessages = 200'000;
+constexpr size_t MessageSize = 128;
+
+struct Callback : WS::IWebSocketMessengerCallback {
+    std::atomic<bool> connected{ false };
+
+    void OnMessageReceived(std::string_view) override {}
+    void OnConnected() override {
+        t_counted = true;  // Runs on the messenger's IO thread
+        connected = true;
+    }
+    void OnDisconnected(const WS::ErrorDetails&) override { connected = false; }
+    void SignalCriticalFailure() override {}
+};
+
+enum class PayloadSource {
+    NewString,   // A freshly allocated std::string per message
+    PoolBuffer,  // A buffer from AcquireSendBuffer
+};
+
+void SendMessages(WS::IWebSocketMessenger& messenger, BenchServer& server, size_t count,
+                  PayloadSource source) {
+    size_t target = server.GetMessagesReceived();
+    for (size_t i = 0; i < count; ++i) {
+        std::string payload = source == PayloadSource::PoolBuffer
+                                  ? messenger.AcquireSendBuffer(MessageSize)
+                                  : std::string();
+        payload.assign(MessageSize, 'x');
+        if (messenger.Send(std::move(payload))) {
+            ++target;
+        }
+    }
+
+    while (server.GetMessagesReceived() < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Returns allocations per message, or a negative value if the messenger did not connect
+template <WS::SendBehavior SendBehaviorT>
+double Run(BenchServer& server, const std::shared_ptr<WS::IMessengerRuntime>& runtime,
+           PayloadSource source) {
+    WS::ConnectionConfig config;
+    config.server_settings.host = "localhost";
+    config.server_settings.port = server.GetPort();
+    config.server_settings.target = "/";
+    config.max_send_queue_size = 4096;
+    // Producers wait for queue space instead of dropping messages
+    config.send_queue_overflow_policy = WS::OverflowPolicy::BlockWithTimeout;
+    config.send_queue_block_timeout = std::chrono::seconds(10);
+
+    Callback callback;
+    auto messenger = WS::CreateWebSocketMessenger<SendBehaviorT>(callback, config, runtime);
+    messenger->Open();
+    for (int i = 0; i < 500 && !callback.connected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!callback.connected) {
+        messenger->Close();
+        return -1.0;
+    }
+
+    SendMessages(*messenger, server, WarmupMessages, source);
+
+    const size_t before = g_allocations.load();
+    SendMessages(*messenger, server, MeasuredMessages, source);
+    const size_t allocations = g_allocations.load() - before;
+
+    messenger->Close();
+    return static_cast<double>(allocations) / static_cast<double>(MeasuredMessages);
+}
+
+void Report(const char* behavior, const char* payload, double allocations_per_message) {
+    std::cout << std::setw(10) << behavior << std::setw(14) << payload;
+    if (allocations_per_message < 0) {
+        std::cout << std::setw(16) << "not connected" << std::endl;
+    } else {
+        std::cout << std::setw(16) << std::fixed << std::setprecision(3) << allocations_per_message
+                  << std::endl;
+    }
+}
+}  // namespace
+
+int main() {
+    auto server = BenchServer::Start(1);
+    if (!server) {
+        std::cerr << "Failed to start the benchmark server" << std::endl;
+        return 1;
+    }
+    server->SetMode(ServerMode::Sink);
+
+    WS::RuntimeConfig runtime_config;
+    runtime_config.additional_trusted_ca_pem = server->GetCertificatePem();
+    runtime_config.io_thread_count = 1;
+    const auto runtime = WS::CreateMessengerRuntime(runtime_config);
+    t_counted = true;
+
+    std::cout << std::setw(10) << "behavior" << std::setw(14) << "payload" << std::setw(16)
+              << "allocs/msg" << std::endl;
+
+    for (const PayloadSource source : { PayloadSource::NewString, PayloadSource::PoolBuffer }) {
+        const char* payload = source == PayloadSource::NewString ? "new string" : "pool buffer";
+        Report("Async", payload, Run<WS::SendBehavior::Async>(*server, runtime, source));
+        Report("Batched", payload, Run<WS::SendBehavior::Batched>(*server, runtime, source));
+        Report("Sync", payload, Run<WS::SendBehavior::Sync>(*server, runtime, source));
+    }
+
+    return 0;
+}
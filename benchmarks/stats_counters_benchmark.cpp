@@ -0,0 +1,119 @@
+// Measures the per-message cost of the messenger's statistics counters.
+//
+// Replays the counter updates made for every message on the async send path: producer threads
+// bump the send queue size when a message is accepted, while the IO thread decrements it and
+// records the sent message, its bytes and the wire bytes. Compares the previous layout (adjacent
+// seq_cst atomics) with the sharded, relaxed counters used now.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Implementation/Internal/ShardedCounters.hpp"
+
+namespace {
+constexpr size_t MessagesPerProducer = 2'000'000;
+constexpr size_t MessageSize = 128;
+
+enum class StatCounter {
+    MessagesSent,
+    BytesSent,
+    SendQueueSize,
+    WireBytesSent,
+    Count,
+};
+
+// Layout of the counters before sharding: adjacent atomics updated with seq_cst operations
+struct PackedStats {
+    std::atomic<size_t> total_messages_sent{ 0 };
+    std::atomic<size_t> total_messages_received{ 0 };
+    std::atomic<size_t> total_bytes_sent{ 0 };
+    std::atomic<size_t> total_bytes_received{ 0 };
+    std::atomic<size_t> current_send_queue_size{ 0 };
+    std::atomic<size_t> total_wire_bytes_sent{ 0 };
+
+    void OnAccepted() { current_send_queue_size++; }
+    void OnWritten() {
+        current_send_queue_size--;
+        total_messages_sent++;
+        total_bytes_sent += MessageSize;
+        total_wire_bytes_sent += MessageSize + 8;
+    }
+    size_t MessagesSent() const { return total_messages_sent.load(); }
+};
+
+struct ShardedStats {
+    WS::ShardedCounters<StatCounter> counters;
+
+    void OnAccepted() { counters.Add(StatCounter::SendQueueSize); }
+    void OnWritten() {
+        counters.Subtract(StatCounter::SendQueueSize);
+        counters.Add(StatCounter::MessagesSent);
+        counters.Add(StatCounter::BytesSent, MessageSize);
+        counters.Add(StatCounter::WireBytesSent, MessageSize + 8);
+    }
+    size_t MessagesSent() const { return counters.Load(StatCounter::MessagesSent); }
+};
+
+// Returns nanoseconds per message
+template <typename StatsT>
+double Run(size_t producer_count) {
+    StatsT stats;
+    const size_t total_messages = producer_count * MessagesPerProducer;
+    std::atomic<bool> start{ false };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < producer_count; ++i) {
+        threads.emplace_back([&] {
+            while (!start.load(std::memory_order_acquire)) {
+            }
+            for (size_t n = 0; n < MessagesPerProducer; ++n) {
+                stats.OnAccepted();
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        while (!start.load(std::memory_order_acquire)) {
+        }
+        for (size_t n = 0; n < total_messages; ++n) {
+            stats.OnWritten();
+        }
+    });
+
+    const auto started = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    if (stats.MessagesSent() != total_messages) {
+        std::cerr << "Counter mismatch: " << stats.MessagesSent() << " != " << total_messages
+                  << std::endl;
+    }
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(total_messages);
+}
+}  // namespace
+
+int main() {
+    std::cout << std::setw(10) << "producers" << std::setw(16) << "packed ns/msg" << std::setw(16)
+              << "sharded ns/msg" << std::endl;
+
+    const size_t max_producers = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+    for (size_t producers = 1; producers <= max_producers; producers *= 2) {
+        const double packed = Run<PackedStats>(producers);
+        const double sharded = Run<ShardedStats>(producers);
+        std::cout << std::setw(10) << producers << std::setw(16) << std::fixed
+                  << std::setprecision(2) << packed << std::setw(16) << sharded << std::endl;
+    }
+
+    return 0;
+}
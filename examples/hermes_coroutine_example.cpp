@@ -0,0 +1,73 @@
+#include <AwaitableWebSocketMessenger.hpp>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+class ConnectionCallback : public WS::IWebSocketMessengerCallback {
+  public:
+    // Messages are received with AsyncReceive instead
+    void OnMessageReceived(std::string_view) override {}
+
+    void OnConnected() override { std::cout << "Connected to server" << std::endl; }
+
+    void OnDisconnected(const WS::ErrorDetails& error) override {
+        std::cout << "Disconnected: " << error.message << " (code: " << error.code << ")"
+                  << std::endl;
+    }
+
+    void SignalCriticalFailure() override {
+        std::cout << "Critical failure threshold reached" << std::endl;
+    }
+};
+
+boost::asio::awaitable<void> RequestResponse(WS::IAwaitableWebSocketMessenger& messenger) {
+    // echo.websocket.org greets every new connection before echoing
+    if (auto greeting = co_await messenger.AsyncReceive()) {
+        std::cout << "[greeting] " << greeting->payload << std::endl;
+    }
+
+    for (int i = 1; i <= 3; ++i) {
+        const std::string request = "coroutine request #" + std::to_string(i);
+
+        // The coroutine is suspended, not a thread, until the message has been written
+        if (co_await messenger.AsyncSend(request) != WS::MessageWriteStatus::Success) {
+            std::cerr << "Failed to send: " << request << std::endl;
+            co_return;
+        }
+
+        auto response = co_await messenger.AsyncReceive();
+        if (!response) {
+            std::cerr << "Messenger closed" << std::endl;
+            co_return;
+        }
+        std::cout << "[coroutine echo] " << response->payload << std::endl;
+    }
+}
+}  // namespace
+
+int main() {
+    ConnectionCallback callback;
+
+    WS::ConnectionConfig config{};
+    config.server_settings.host = "echo.websocket.org";
+    config.server_settings.port = 443;
+    config.server_settings.target = "/";
+
+    auto messenger = WS::CreateAwaitableWebSocketMessenger(callback, config);
+    if (!messenger->Open()) {
+        std::cerr << "Failed to open messenger" << std::endl;
+        return 1;
+    }
+
+    boost::asio::io_context io_context;
+    boost::asio::co_spawn(io_context, RequestResponse(*messenger), boost::asio::detached);
+    io_context.run();
+
+    messenger->Close();
+}
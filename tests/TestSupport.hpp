@@ -0,0 +1,53 @@
+#pragma once
+
+#include <WebSocketMessenger.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "bench_server.hpp"
+
+// Test executables run their cases in order and stop at the first failed check
+#define HERMES_CHECK(condition)                                                                 \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(EXIT_FAILURE);                                                            \
+        }                                                                                       \
+    } while (false)
+
+namespace HermesTest {
+constexpr std::chrono::seconds WaitTimeout{ 10 };
+
+// Polls `predicate` until it holds or `timeout` passes; returns its last result
+template <typename PredicateT>
+bool WaitUntil(PredicateT&& predicate, std::chrono::milliseconds timeout = WaitTimeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return predicate();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Runtime whose messengers trust the test server's certificate
+inline std::shared_ptr<WS::IMessengerRuntime> CreateRuntime(
+    const HermesBench::BenchServer& server) {
+    WS::RuntimeConfig config;
+    config.additional_trusted_ca_pem = server.GetCertificatePem();
+    return WS::CreateMessengerRuntime(config);
+}
+
+inline WS::ConnectionConfig CreateConfig(uint16_t port) {
+    WS::ConnectionConfig config;
+    config.server_settings.host = "localhost";
+    config.server_settings.port = port;
+    config.server_settings.target = "/";
+    return config;
+}
+}  // namespace HermesTest
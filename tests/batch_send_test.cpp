@@ -0,0 +1,61 @@
+// Batched sends: every message of a batch arrives as its own message, and the batch goes out in
+// one TLS write rather than a TLS record per message.
+
+#include <string>
+
+#include "TestSupport.hpp"
+
+namespace {
+using namespace HermesTest;
+
+constexpr size_t MessageCount = 64;
+constexpr size_t MessageSize = 16;
+
+// Queues all messages before connecting, so the first write takes them as one batch, and returns
+// the bytes the connection wrote to the socket
+template <WS::SendBehavior SendBehaviorT>
+size_t SendQueuedMessages(HermesBench::BenchServer& server) {
+    struct Callback : WS::IWebSocketMessengerCallback {
+        void OnMessageReceived(std::string_view) override {}
+        void OnConnected() override {}
+        void OnDisconnected(const WS::ErrorDetails&) override {}
+        void SignalCriticalFailure() override {}
+    } callback;
+
+    server.ResetMeasurement();
+
+    // A runtime of its own, so no handshake resumes a session another one cached
+    WS::ConnectionConfig config = CreateConfig(server.GetPort());
+    config.batch_settings.max_batch_count = MessageCount;
+    auto messenger = WS::CreateWebSocketMessenger<SendBehaviorT>(callback, config,
+                                                                 CreateRuntime(server));
+
+    for (size_t i = 0; i < MessageCount; ++i) {
+        std::string message(MessageSize, 'x');
+        HermesBench::StampMessage(message);
+        HERMES_CHECK(messenger->Send(std::move(message), { WS::MessageType::Binary }));
+    }
+    HERMES_CHECK(messenger->Open());
+
+    HERMES_CHECK(WaitUntil([&] { return server.GetMessagesReceived() == MessageCount; }));
+    HERMES_CHECK(WaitUntil(
+        [&] { return messenger->GetConnectionStats().total_messages_sent == MessageCount; }));
+    HERMES_CHECK(server.GetBytesReceived() == MessageCount * MessageSize);
+
+    const size_t wire_bytes = messenger->GetConnectionStats().total_wire_bytes_sent;
+    messenger->Close();
+    return wire_bytes;
+}
+}  // namespace
+
+int main() {
+    auto server = HermesBench::BenchServer::Start(1);
+    HERMES_CHECK(server);
+
+    const size_t async_wire_bytes = SendQueuedMessages<WS::SendBehavior::Async>(*server);
+    const size_t batched_wire_bytes = SendQueuedMessages<WS::SendBehavior::Batched>(*server);
+
+    // Each TLS record adds at least 16 bytes of authentication tag on top of its header
+    HERMES_CHECK(batched_wire_bytes + (MessageCount - 1) * 16 < async_wire_bytes);
+    return 0;
+}
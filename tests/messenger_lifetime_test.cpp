@@ -0,0 +1,98 @@
+// Destroying a messenger from its own callbacks: nothing touches it afterwards, its connection
+// still gets closed, and a private runtime destroyed on its own IO thread lets go of the thread.
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "TestSupport.hpp"
+
+namespace {
+using namespace HermesTest;
+
+// Hands its messenger's last reference to the callback `DestroyOn` names, and counts the
+// destructions
+struct DestroyingCallback : WS::IWebSocketMessengerCallback {
+    enum class Event { Disconnected, CriticalFailure, MessageReceived };
+
+    explicit DestroyingCallback(Event event) : destroy_on(event) {}
+
+    void OnMessageReceived(std::string_view) override { Destroy(Event::MessageReceived); }
+    void OnConnected() override {}
+    void OnDisconnected(const WS::ErrorDetails&) override { Destroy(Event::Disconnected); }
+    void SignalCriticalFailure() override { Destroy(Event::CriticalFailure); }
+
+    void Destroy(Event event) {
+        if (event == destroy_on && messenger) {
+            messenger.reset();
+            destroyed.store(true);
+        }
+    }
+
+    const Event destroy_on;
+    std::shared_ptr<WS::IWebSocketMessenger> messenger;
+    std::atomic<bool> destroyed{ false };
+};
+
+// Nothing listens on this port, so every connection attempt fails at once
+WS::ConnectionConfig CreateUnreachableConfig() {
+    WS::ConnectionConfig config = CreateConfig(1);
+    config.server_settings.host = "127.0.0.1";
+    return config;
+}
+
+void DestroyOnDisconnected(std::shared_ptr<WS::IMessengerRuntime> runtime) {
+    DestroyingCallback callback(DestroyingCallback::Event::Disconnected);
+    callback.messenger = WS::CreateWebSocketMessenger<WS::SendBehavior::Async>(
+        callback, CreateUnreachableConfig(), std::move(runtime));
+    HERMES_CHECK(callback.messenger->Open());
+    HERMES_CHECK(WaitUntil([&] { return callback.destroyed.load(); }));
+}
+
+void DestroyOnCriticalFailure(std::shared_ptr<WS::IMessengerRuntime> runtime) {
+    DestroyingCallback callback(DestroyingCallback::Event::CriticalFailure);
+    WS::ConnectionConfig config = CreateUnreachableConfig();
+    config.critical_failure_threshold = -1;  // Give up after the first failed attempt
+    callback.messenger = WS::CreateWebSocketMessenger<WS::SendBehavior::Async>(
+        callback, config, std::move(runtime));
+    HERMES_CHECK(callback.messenger->Open());
+    HERMES_CHECK(WaitUntil([&] { return callback.destroyed.load(); }));
+}
+
+// The messenger is destroyed while connected, from a dispatch task on a thread of its own
+void DestroyOnDispatchedMessage(HermesBench::BenchServer& server,
+                                std::shared_ptr<WS::IMessengerRuntime> runtime) {
+    DestroyingCallback callback(DestroyingCallback::Event::MessageReceived);
+    WS::ConnectionConfig config = CreateConfig(server.GetPort());
+    config.receive_dispatch.executor = [](std::function<void()> task) {
+        std::thread(std::move(task)).detach();
+    };
+    callback.messenger =
+        WS::CreateWebSocketMessenger<WS::SendBehavior::Async>(callback, config, runtime);
+
+    HERMES_CHECK(callback.messenger->Send(std::string("message"), {}));
+    HERMES_CHECK(callback.messenger->Open());
+    HERMES_CHECK(WaitUntil([&] { return callback.destroyed.load(); }));
+}
+}  // namespace
+
+int main() {
+    auto server = HermesBench::BenchServer::Start(1);
+    HERMES_CHECK(server);
+    server->SetMode(HermesBench::ServerMode::Echo);
+
+    // Private runtimes, whose last reference goes away on their own IO thread
+    DestroyOnDisconnected(nullptr);
+    DestroyOnCriticalFailure(nullptr);
+
+    // A shared runtime only stops once every connection on it is closed, so releasing it would
+    // hang on a connection left open
+    auto runtime = CreateRuntime(*server);
+    DestroyOnDisconnected(runtime);
+    DestroyOnCriticalFailure(runtime);
+    DestroyOnDispatchedMessage(*server, runtime);
+    runtime.reset();
+    return 0;
+}
@@ -0,0 +1,258 @@
+// The durable send log: what a reopened log still holds after a torn append, after part of it
+// was consumed, and across segment files, that it stays within its disk limit, and that it waits
+// out a segment it cannot map.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "Implementation/Internal/SegmentLog.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+constexpr size_t SegmentSize = 4096;
+
+// A fresh, empty directory for one case
+std::filesystem::path CreateLogDirectory(const std::string& name) {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / ("hermes-segment-log-test-" + name);
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+std::unique_ptr<WS::SegmentLog> OpenLog(const std::filesystem::path& directory,
+                                        uint64_t max_bytes = 0) {
+    auto log = WS::SegmentLog::Open(directory, SegmentSize, max_bytes);
+    HERMES_CHECK(log);
+    return log;
+}
+
+std::string Payload(size_t index, size_t size = 16) {
+    std::string payload = std::to_string(index);
+    payload.resize(size, '.');
+    return payload;
+}
+
+void Append(WS::SegmentLog& log, size_t index, size_t size = 16) {
+    HERMES_CHECK(log.Append(Payload(index, size), 1, static_cast<int64_t>(index)));
+}
+
+void ExpectFrontAndAcknowledge(WS::SegmentLog& log, size_t index, size_t size = 16) {
+    const auto record = log.Front();
+    HERMES_CHECK(record);
+    HERMES_CHECK(record->payload == Payload(index, size));
+    HERMES_CHECK(record->timestamp == static_cast<int64_t>(index));
+    log.Acknowledge();
+}
+
+size_t CountSegmentFiles(const std::filesystem::path& directory) {
+    return static_cast<size_t>(std::distance(std::filesystem::directory_iterator(directory),
+                                             std::filesystem::directory_iterator()));
+}
+
+uint64_t DiskUsage(const std::filesystem::path& directory) {
+    uint64_t bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+std::filesystem::path SegmentFile(const std::filesystem::path& directory, int sequence) {
+    char name[40];
+    std::snprintf(name, sizeof(name), "segment-%020d.log", sequence);
+    return directory / name;
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+// A crash between writing a record and marking it complete leaves it without its marker
+void TornRecordIsIgnored() {
+    const auto directory = CreateLogDirectory("torn");
+    {
+        auto log = OpenLog(directory);
+        Append(*log, 0);
+        Append(*log, 1);
+    }
+
+    const auto segment = SegmentFile(directory, 0);
+    std::string contents = ReadFile(segment);
+    const uint32_t marker = 0x57534c47;
+    const size_t last_marker =
+        contents.rfind(std::string(reinterpret_cast<const char*>(&marker), sizeof(marker)));
+    HERMES_CHECK(last_marker != std::string::npos && last_marker > 0);
+    std::memset(contents.data() + last_marker, 0, sizeof(marker));
+    WriteFile(segment, contents);
+
+    auto log = OpenLog(directory);
+    HERMES_CHECK(log->Size() == 1);
+
+    // The next append takes the torn record's place
+    Append(*log, 2);
+    ExpectFrontAndAcknowledge(*log, 0);
+    ExpectFrontAndAcknowledge(*log, 2);
+    HERMES_CHECK(!log->Front());
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+
+void AcknowledgedPrefixIsSkipped() {
+    const auto directory = CreateLogDirectory("acknowledged");
+    {
+        auto log = OpenLog(directory);
+        for (size_t i = 0; i < 5; ++i) {
+            Append(*log, i);
+        }
+        for (size_t i = 0; i < 3; ++i) {
+            ExpectFrontAndAcknowledge(*log, i);
+        }
+    }
+
+    auto log = OpenLog(directory);
+    HERMES_CHECK(log->Size() == 2);
+    ExpectFrontAndAcknowledge(*log, 3);
+    ExpectFrontAndAcknowledge(*log, 4);
+    HERMES_CHECK(!log->Front());
+    HERMES_CHECK(log->Size() == 0);
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+
+// Records of a quarter segment, so every segment holds three
+constexpr size_t LargePayloadSize = SegmentSize / 4;
+constexpr size_t LargeRecordCount = 10;
+
+void RecordsRollOverAcrossSegments() {
+    const auto directory = CreateLogDirectory("rollover");
+    {
+        auto log = OpenLog(directory);
+        for (size_t i = 0; i < LargeRecordCount; ++i) {
+            Append(*log, i, LargePayloadSize);
+        }
+        HERMES_CHECK(CountSegmentFiles(directory) == 4);
+
+        // Consuming the first segment deletes it
+        for (size_t i = 0; i < 4; ++i) {
+            ExpectFrontAndAcknowledge(*log, i, LargePayloadSize);
+        }
+        HERMES_CHECK(CountSegmentFiles(directory) == 3);
+    }
+
+    auto log = OpenLog(directory);
+    HERMES_CHECK(log->Size() == LargeRecordCount - 4);
+    for (size_t i = 4; i < LargeRecordCount; ++i) {
+        ExpectFrontAndAcknowledge(*log, i, LargePayloadSize);
+    }
+    HERMES_CHECK(!log->Front());
+    HERMES_CHECK(CountSegmentFiles(directory) == 1);
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+
+void SegmentLimitRejectsAppends() {
+    const auto directory = CreateLogDirectory("limit");
+    auto log = OpenLog(directory, 2 * SegmentSize);
+    for (size_t i = 0; i < 6; ++i) {
+        Append(*log, i, LargePayloadSize);
+    }
+    HERMES_CHECK(!log->Append(Payload(6, LargePayloadSize), 1, 6));
+
+    // Room frees up once the front segment is consumed
+    for (size_t i = 0; i < 4; ++i) {
+        ExpectFrontAndAcknowledge(*log, i, LargePayloadSize);
+    }
+    Append(*log, 6, LargePayloadSize);
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+
+// Fills a log with `max_bytes` and checks the files never take more
+void ExpectDiskLimit(size_t segment_size, uint64_t max_bytes, size_t expected_segments) {
+    const auto directory = CreateLogDirectory("disk-limit");
+    auto log = WS::SegmentLog::Open(directory, segment_size, max_bytes);
+    HERMES_CHECK(log);
+
+    size_t appended = 0;
+    while (log->Append(Payload(appended, 256), 1, static_cast<int64_t>(appended))) {
+        ++appended;
+        HERMES_CHECK(DiskUsage(directory) <= max_bytes);
+    }
+    HERMES_CHECK(appended > 0);
+    HERMES_CHECK(CountSegmentFiles(directory) == expected_segments);
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+
+void DiskLimitIsNeverExceeded() {
+    // Segments fit the limit whole; the remainder is left unused
+    ExpectDiskLimit(SegmentSize, 3 * SegmentSize + 100, 3);
+
+    // Too small for two segments of the requested size, so they shrink to half the limit
+    ExpectDiskLimit(64 * 1024 * 1024, 3 * SegmentSize + 100, 2);
+
+    // Not even two segments of the minimum size fit
+    const auto directory = CreateLogDirectory("too-small");
+    HERMES_CHECK(!WS::SegmentLog::Open(directory, SegmentSize, 2 * SegmentSize - 1));
+    std::filesystem::remove_all(directory);
+}
+
+// A segment between the front and the back is only mapped once the front reaches it
+void UnmappableSegmentIsRetried() {
+    const auto directory = CreateLogDirectory("unmappable");
+    auto log = OpenLog(directory);
+    for (size_t i = 0; i < 7; ++i) {
+        Append(*log, i, LargePayloadSize);
+    }
+
+    const auto middle = SegmentFile(directory, 1);
+    const std::string contents = ReadFile(middle);
+    std::filesystem::remove(middle);
+    std::filesystem::create_directory(middle);
+
+    for (size_t i = 0; i < 3; ++i) {
+        ExpectFrontAndAcknowledge(*log, i, LargePayloadSize);
+    }
+    HERMES_CHECK(!log->Front());
+    HERMES_CHECK(!log->Front());
+    log->Acknowledge();
+    HERMES_CHECK(log->Size() == 4);
+
+    std::filesystem::remove(middle);
+    WriteFile(middle, contents);
+    for (size_t i = 3; i < 7; ++i) {
+        ExpectFrontAndAcknowledge(*log, i, LargePayloadSize);
+    }
+    HERMES_CHECK(!log->Front());
+
+    log.reset();
+    std::filesystem::remove_all(directory);
+}
+}  // namespace
+
+int main() {
+    TornRecordIsIgnored();
+    AcknowledgedPrefixIsSkipped();
+    RecordsRollOverAcrossSegments();
+    SegmentLimitRejectsAppends();
+    DiskLimitIsNeverExceeded();
+    UnmappableSegmentIsRetried();
+    return 0;
+}
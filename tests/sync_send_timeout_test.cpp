@@ -0,0 +1,107 @@
+// Sync sends with a timeout: a message whose write never started before the caller gave up is not
+// sent once the connection comes up.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+
+#include "TestSupport.hpp"
+
+namespace {
+using namespace HermesTest;
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+// Accepts a connection and holds it, so the messenger is stuck in its TLS handshake, until
+// `Forward` relays it to the server
+class HoldingRelay {
+  public:
+    HoldingRelay() : acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0)) {}
+
+    ~HoldingRelay() {
+        boost::system::error_code ignored;
+        client_.shutdown(tcp::socket::shutdown_both, ignored);
+        server_.shutdown(tcp::socket::shutdown_both, ignored);
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    uint16_t GetPort() const { return acceptor_.local_endpoint().port(); }
+
+    void Accept() { acceptor_.accept(client_); }
+
+    void Forward(uint16_t port) {
+        server_.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), port));
+        threads_.emplace_back([this] { Pipe(client_, server_); });
+        threads_.emplace_back([this] { Pipe(server_, client_); });
+    }
+
+  private:
+    static void Pipe(tcp::socket& from, tcp::socket& to) {
+        char buffer[16 * 1024];
+        boost::system::error_code ec;
+        while (const size_t size = from.read_some(net::buffer(buffer), ec)) {
+            net::write(to, net::buffer(buffer, size), ec);
+            if (ec) {
+                break;
+            }
+        }
+        to.shutdown(tcp::socket::shutdown_send, ec);
+    }
+
+  private:
+    net::io_context ioc_;
+    tcp::acceptor acceptor_;
+    tcp::socket client_{ ioc_ };
+    tcp::socket server_{ ioc_ };
+    std::vector<std::thread> threads_;
+};
+
+struct Callback : WS::IWebSocketMessengerCallback {
+    void OnMessageReceived(std::string_view) override {}
+    void OnConnected() override { connected.store(true); }
+    void OnDisconnected(const WS::ErrorDetails&) override {}
+    void SignalCriticalFailure() override {}
+
+    std::atomic<bool> connected{ false };
+};
+}  // namespace
+
+int main() {
+    auto server = HermesBench::BenchServer::Start(1);
+    HERMES_CHECK(server);
+
+    HoldingRelay relay;
+    Callback callback;
+    WS::ConnectionConfig config = CreateConfig(relay.GetPort());
+    config.sync_send_settings.timeout = std::chrono::milliseconds(50);
+    auto messenger = WS::CreateWebSocketMessenger<WS::SendBehavior::Sync>(callback, config,
+                                                                          CreateRuntime(*server));
+
+    HERMES_CHECK(messenger->Open());
+    relay.Accept();
+
+    const std::string abandoned = "abandoned while disconnected";
+    HERMES_CHECK(messenger->TrySend(std::string(abandoned)) == WS::SendResult::Timeout);
+
+    relay.Forward(server->GetPort());
+    HERMES_CHECK(WaitUntil([&] { return callback.connected.load(); }));
+
+    // Messages are written in order, so the abandoned one would have arrived first
+    const std::string written = "written";
+    HERMES_CHECK(messenger->TrySend(std::string(written)) == WS::SendResult::Accepted);
+    HERMES_CHECK(WaitUntil([&] { return server->GetMessagesReceived() == 1; }));
+    HERMES_CHECK(server->GetBytesReceived() == written.size());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    HERMES_CHECK(server->GetMessagesReceived() == 1);
+
+    messenger->Close();
+    return 0;
+}